@@ -0,0 +1,225 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sys/resource.h>
+#include <unistd.h>
+
+// Opt-in heap allocation counter for our own per-event code.
+// Compile a generator with -DHIGGS_COUNT_ALLOCS to replace the global operator new. Only
+// allocations made while an alloccount::Scope is open on the calling thread are counted;
+// alloccount::Pause masks calls into Pythia/FastJet (ClusterSequence, inclusive_jets) so the
+// tally covers exactly the code we control. Without the define the scopes are empty structs.
+// A counting build (make count-allocs) treats any steady-state allocation as a failure: the
+// generators return alloccount::exitStatus(0), which is non-zero once report() has seen one,
+// and make check-allocs runs them on a short seeded sample.
+//
+// Compile with -DHIGGS_MEMORY_STATS (make memstats) for per-stage memory accounting: every
+// allocation is charged to the memstats::Stage open on the calling thread (generation,
+// clustering, association, output, or other outside any stage), with bytes allocated and bytes
+// still live per stage, and memstats::sample() tracks resident set size per event. Each block
+// carries a 16-byte header with its size and stage so frees are charged back to the stage that
+// allocated it. Without the define StageScope is empty and sample() / report() do nothing.
+//
+// The replacement operators are defined here, so include this header from one .cc only.
+namespace alloccount {
+
+inline thread_local int depth = 0;
+inline std::atomic<unsigned long long> counted{0};
+inline std::atomic<bool> steadyStateAllocated{false};
+
+struct Scope {
+    Scope() { ++depth; }
+    ~Scope() { --depth; }
+};
+
+struct Pause {
+    int saved;
+    bool paused = true;
+    Pause() : saved(depth) { depth = 0; }
+    ~Pause() { resume(); }
+    void resume() {
+        if (paused) depth = saved;
+        paused = false;
+    }
+};
+
+inline void reset() { counted = 0; }
+
+// Summary line; silent unless counting is compiled in
+inline void report(std::ostream& out, long nEvents) {
+#ifdef HIGGS_COUNT_ALLOCS
+    out << "Allocation counter: " << counted.load() << " heap allocations in analysis code over "
+        << nEvents << " steady-state events" << std::endl;
+    if (nEvents > 0 && counted.load() > 0) steadyStateAllocated = true;
+#else
+    (void)out; (void)nEvents;
+#endif
+}
+
+// Exit status for main(): `status`, or 2 if a counting build saw steady-state allocations
+inline int exitStatus(int status) {
+#ifdef HIGGS_COUNT_ALLOCS
+    if (status == 0 && steadyStateAllocated) {
+        std::cerr << "Error: Analysis code allocated on the heap in steady state" << std::endl;
+        return 2;
+    }
+#endif
+    return status;
+}
+
+}
+
+namespace memstats {
+
+enum class Stage { Other, Generation, Clustering, Association, Output, Count };
+
+inline const char* stageName(Stage stage) {
+    static const char* names[] = {"other", "generation", "clustering", "association", "output"};
+    return names[static_cast<int>(stage)];
+}
+
+inline thread_local Stage current = Stage::Other;
+
+struct StageCounters {
+    std::atomic<unsigned long long> allocations{0}, bytes{0};
+    std::atomic<long long> live{0}, peakLive{0};
+};
+
+inline StageCounters counters[static_cast<int>(Stage::Count)];
+inline std::atomic<long> sampledPeakKb{0}, sampledPeakEvent{-1}, nSamples{0};
+
+// Charges allocations on this thread to `stage` until destroyed
+struct StageScope {
+#ifdef HIGGS_MEMORY_STATS
+    Stage saved;
+    explicit StageScope(Stage stage) : saved(current) { current = stage; }
+    ~StageScope() { current = saved; }
+#else
+    explicit StageScope(Stage) {}
+#endif
+};
+
+// Header in front of every block; 16 bytes keeps malloc's alignment
+struct alignas(16) BlockHeader {
+    std::size_t size;
+    Stage stage;
+};
+
+inline void* allocate(std::size_t size) {
+    void* block = std::malloc(sizeof(BlockHeader) + size);
+    if (!block) throw std::bad_alloc();
+    BlockHeader* header = static_cast<BlockHeader*>(block);
+    header->size = size;
+    header->stage = current;
+    StageCounters& c = counters[static_cast<int>(current)];
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.bytes.fetch_add(size, std::memory_order_relaxed);
+    long long live = c.live.fetch_add(static_cast<long long>(size), std::memory_order_relaxed) + size;
+    long long peak = c.peakLive.load(std::memory_order_relaxed);
+    while (live > peak && !c.peakLive.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    return header + 1;
+}
+
+// Out of line, or GCC sees free() on a pointer from operator new and warns
+__attribute__((noinline)) inline void release(void* p) {
+    if (!p) return;
+    BlockHeader* header = static_cast<BlockHeader*>(p) - 1;
+    counters[static_cast<int>(header->stage)].live.fetch_sub(static_cast<long long>(header->size),
+                                                             std::memory_order_relaxed);
+    std::free(header);
+}
+
+// Current resident set size from /proc/self/statm, 0 if unavailable
+inline long currentRssKb() {
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    long pages = 0, resident = 0;
+    int n = std::fscanf(statm, "%ld %ld", &pages, &resident);
+    std::fclose(statm);
+    return n == 2 ? resident * (sysconf(_SC_PAGESIZE) / 1024) : 0;
+}
+
+// Kernel high-water mark of the resident set size
+inline long peakRssKb() {
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+}
+
+// Record the resident set size after event `event` (of whichever run reaches the peak)
+inline void sample(long event) {
+#ifdef HIGGS_MEMORY_STATS
+    long rss = currentRssKb();
+    nSamples.fetch_add(1, std::memory_order_relaxed);
+    long peak = sampledPeakKb.load(std::memory_order_relaxed);
+    while (rss > peak) {
+        if (sampledPeakKb.compare_exchange_weak(peak, rss, std::memory_order_relaxed)) {
+            sampledPeakEvent.store(event, std::memory_order_relaxed);
+            break;
+        }
+    }
+#else
+    (void)event;
+#endif
+}
+
+// Per-stage table and RSS summary; silent unless memory stats are compiled in
+inline void report(std::ostream& out) {
+#ifdef HIGGS_MEMORY_STATS
+    const double kMiB = 1024.0 * 1024.0;
+    out << "Memory by stage: allocations, MiB allocated, MiB live now, peak MiB live" << std::endl;
+    for (int s = 0; s < static_cast<int>(Stage::Count); s++) {
+        const StageCounters& c = counters[s];
+        out << "  " << stageName(static_cast<Stage>(s)) << "  " << c.allocations.load() << "  "
+            << c.bytes.load() / kMiB << "  " << c.live.load() / kMiB << "  " << c.peakLive.load() / kMiB << std::endl;
+    }
+    out << "Peak RSS: " << peakRssKb() / 1024.0 << " MiB (current " << currentRssKb() / 1024.0 << " MiB";
+    if (nSamples.load() > 0) {
+        out << ", sampled peak " << sampledPeakKb.load() / 1024.0 << " MiB after event " << sampledPeakEvent.load();
+    }
+    out << ")" << std::endl;
+#else
+    (void)out;
+#endif
+}
+
+// Print report() to stdout when the program exits, however it returns
+inline void reportAtExit() {
+#ifdef HIGGS_MEMORY_STATS
+    static bool registered = false;
+    if (!registered) std::atexit([] { report(std::cout); });
+    registered = true;
+#endif
+}
+
+}
+
+#if defined(HIGGS_COUNT_ALLOCS) || defined(HIGGS_MEMORY_STATS)
+void* operator new(std::size_t size) {
+#ifdef HIGGS_COUNT_ALLOCS
+    if (alloccount::depth > 0) alloccount::counted.fetch_add(1, std::memory_order_relaxed);
+#endif
+#ifdef HIGGS_MEMORY_STATS
+    return memstats::allocate(size);
+#else
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+#endif
+}
+#ifdef HIGGS_MEMORY_STATS
+void operator delete(void* p) noexcept { memstats::release(p); }
+#else
+void operator delete(void* p) noexcept { std::free(p); }
+#endif
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { operator delete(p); }
+#endif
+
+#endif
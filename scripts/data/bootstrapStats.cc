@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <cstdint>
+#include "bootstrapStats.h"
+
+// C ABI of bootstrapStats.h, built as libbootstrapStats.so and loaded by bootstrapStats.py
+// through ctypes. Arrays are caller-owned; counts arrays hold nBins + 1 entries, the last being
+// the "other" bin. Functions return 0 on success and -1 on invalid arguments.
+
+extern "C" {
+
+int hs_stats_version() {
+    return 1;
+}
+
+// Bin index of every value of a float32 column (e.g. ProductionChannel of a training matrix,
+// stride = columns per row), or -1 if it matches none of binValues. Returns the number matched.
+int64_t hs_map_bins_f32(const float* values, int64_t n, int64_t stride, const float* binValues, int32_t nBins,
+                        int32_t* bins) {
+    if (!values || !bins || n < 0 || stride < 1 || nBins < 0) return -1;
+    int64_t matched = 0;
+    for (int64_t i = 0; i < n; i++) {
+        float value = values[i * stride];
+        int32_t bin = -1;
+        for (int32_t b = 0; b < nBins; b++) {
+            if (binValues[b] == value) {
+                bin = b;
+                break;
+            }
+        }
+        bins[i] = bin;
+        matched += (bin >= 0);
+    }
+    return matched;
+}
+
+int hs_bin_counts(const int32_t* bins, const int64_t* offsets, int64_t nEvents, int32_t nBins, int64_t* counts) {
+    if (!bins || !counts || nEvents < 0 || nBins < 0) return -1;
+    TaskPool pool(TaskPool::helpersFor(static_cast<int>(std::min<int64_t>(nEvents >> 16, 1 << 20)) + 1));
+    stats::binCounts(stats::collectPatterns(bins, offsets, nEvents, nBins, pool), nullptr, nBins, counts);
+    return 0;
+}
+
+double hs_chi_square(const int64_t* counts, const double* fractions, int32_t nBins, double* pValue) {
+    return stats::chiSquare(counts, fractions, nBins, pValue);
+}
+
+int hs_bootstrap_chi_square(const int32_t* bins, const int64_t* offsets, int64_t nEvents, const double* fractions,
+                            int32_t nBins, int32_t nReplicas, uint64_t seed, int32_t nThreads, double* chi2,
+                            double* pValues, int64_t* counts) {
+    if (!bins || !fractions || !chi2 || nEvents <= 0 || nBins <= 0 || nReplicas < 0) return -1;
+    stats::bootstrapChiSquare(bins, offsets, nEvents, fractions, nBins, nReplicas, seed, nThreads, chi2, pValues, counts);
+    return 0;
+}
+
+}
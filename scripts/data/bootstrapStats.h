@@ -0,0 +1,178 @@
+#ifndef BOOTSTRAP_STATS_H
+#define BOOTSTRAP_STATS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+#include "eventSeeds.h"
+#include "taskPool.h"
+
+// Binned counts, chi-square goodness of fit and its bootstrap distribution, for chisquare.py and
+// nfchi.py through the C ABI of bootstrapStats.cc.
+//
+// Input is one list of bin indices per event (an event can fill several bins, e.g. one per decay
+// pair), in CSR form: entries offsets[e]..offsets[e+1] of `bins` belong to event e; without
+// offsets every event has exactly one entry. Indices outside [0, nBins) fall into an extra
+// "other" bin, which counts towards the total but not the chi-square, as in the scripts.
+//
+// Bootstrap replicas resample events, not entries. Events with the same list of bins are
+// interchangeable, so the events are first reduced to their distinct bin lists ("patterns") and
+// each replica draws the multinomial multiplicity of every pattern by sequential binomials: the
+// replicas cost O(patterns) each instead of O(events). Replica r is drawn from its own stream
+// seeded with (seed, r), so the results do not depend on the thread count.
+namespace stats {
+
+// Regularized upper incomplete gamma Q(a, x): series below x = a + 1, continued fraction above
+inline double gammaQ(double a, double x) {
+    if (x <= 0) return 1.0;
+    const double logPrefix = a * std::log(x) - x - std::lgamma(a);
+    const double tiny = 1e-300;
+    if (x < a + 1) {
+        double term = 1.0 / a, sum = term;
+        for (int n = 1; n < 1000 && std::fabs(term) > std::fabs(sum) * 1e-16; n++) {
+            term *= x / (a + n);
+            sum += term;
+        }
+        return std::max(0.0, 1.0 - sum * std::exp(logPrefix));
+    }
+    double b = x + 1 - a, c = 1 / tiny, d = 1 / b, h = d;
+    for (int i = 1; i < 1000; i++) {
+        double an = -i * (i - a);
+        b += 2;
+        d = an * d + b;
+        if (std::fabs(d) < tiny) d = tiny;
+        c = b + an / c;
+        if (std::fabs(c) < tiny) c = tiny;
+        d = 1 / d;
+        double delta = d * c;
+        h *= delta;
+        if (std::fabs(delta - 1) < 1e-16) break;
+    }
+    return std::exp(logPrefix) * h;
+}
+
+// Survival function of the chi-square distribution with `dof` degrees of freedom
+inline double chiSquarePValue(double chi2, int dof) {
+    return dof > 0 ? gammaQ(0.5 * dof, 0.5 * chi2) : 1.0;
+}
+
+// Pearson chi-square of counts[0..nBins) against fractions * total, where the total includes the
+// "other" bin counts[nBins]. Bins with zero expected fraction are left out of the sum and the
+// degrees of freedom (scipy.stats.chisquare would return inf for them).
+inline double chiSquare(const int64_t* counts, const double* fractions, int nBins, double* pValue) {
+    int64_t total = 0;
+    for (int b = 0; b <= nBins; b++) total += counts[b];
+    double chi2 = 0.0;
+    int used = 0;
+    for (int b = 0; b < nBins; b++) {
+        if (fractions[b] <= 0) continue;
+        double expected = fractions[b] * total;
+        double diff = counts[b] - expected;
+        chi2 += (expected > 0) ? diff * diff / expected : 0.0;
+        used++;
+    }
+    if (pValue) *pValue = chiSquarePValue(chi2, used - 1);
+    return chi2;
+}
+
+inline int binOf(int32_t bin, int nBins) {
+    return (bin >= 0 && bin < nBins) ? bin : nBins;
+}
+
+// Distinct bin lists and how many events have each, in a fixed (sorted) order
+struct Patterns {
+    std::vector<std::vector<int32_t>> bins;
+    std::vector<int64_t> events;
+};
+
+inline Patterns collectPatterns(const int32_t* bins, const int64_t* offsets, int64_t nEvents, int nBins, TaskPool& pool) {
+    Patterns patterns;
+    if (!offsets) {
+        // One entry per event: the pattern is the bin itself
+        std::vector<int64_t> perBin(nBins + 1, 0);
+        for (int64_t e = 0; e < nEvents; e++) perBin[binOf(bins[e], nBins)]++;
+        for (int b = 0; b <= nBins; b++) {
+            if (perBin[b] == 0) continue;
+            patterns.bins.push_back({b});
+            patterns.events.push_back(perBin[b]);
+        }
+        return patterns;
+    }
+
+    // Chunks reduce independently; the ordered maps make the merged order chunking-independent
+    const int64_t chunkSize = 1 << 16;
+    const int nChunks = static_cast<int>((nEvents + chunkSize - 1) / chunkSize);
+    std::vector<std::map<std::vector<int32_t>, int64_t>> partial(nChunks);
+    auto reduceChunk = [&](int c) {
+        std::vector<int32_t> key;
+        int64_t end = std::min(nEvents, (c + 1) * chunkSize);
+        for (int64_t e = c * chunkSize; e < end; e++) {
+            key.clear();
+            for (int64_t k = offsets[e]; k < offsets[e + 1]; k++) key.push_back(binOf(bins[k], nBins));
+            std::sort(key.begin(), key.end());
+            partial[c][key]++;
+        }
+    };
+    pool.run(nChunks, reduceChunk);
+
+    std::map<std::vector<int32_t>, int64_t> merged;
+    for (auto& chunk : partial) {
+        for (auto& entry : chunk) merged[entry.first] += entry.second;
+    }
+    for (auto& entry : merged) {
+        patterns.bins.push_back(entry.first);
+        patterns.events.push_back(entry.second);
+    }
+    return patterns;
+}
+
+inline void binCounts(const Patterns& patterns, const int64_t* multiplicity, int nBins, int64_t* counts) {
+    std::fill(counts, counts + nBins + 1, 0);
+    for (size_t p = 0; p < patterns.bins.size(); p++) {
+        int64_t m = multiplicity ? multiplicity[p] : patterns.events[p];
+        for (int32_t bin : patterns.bins[p]) counts[bin] += m;
+    }
+}
+
+// Event multiplicities of one bootstrap replica: Multinomial(nEvents, events[p] / nEvents)
+inline void resample(const Patterns& patterns, int64_t nEvents, std::mt19937_64& rng, int64_t* multiplicity) {
+    int64_t drawsLeft = nEvents, eventsLeft = nEvents;
+    const size_t nPatterns = patterns.events.size();
+    for (size_t p = 0; p < nPatterns; p++) {
+        int64_t m = drawsLeft;
+        if (p + 1 < nPatterns && drawsLeft > 0) {
+            double probability = std::min(1.0, double(patterns.events[p]) / eventsLeft);
+            m = std::binomial_distribution<int64_t>(drawsLeft, probability)(rng);
+        }
+        multiplicity[p] = m;
+        drawsLeft -= m;
+        eventsLeft -= patterns.events[p];
+    }
+}
+
+// chi2[r] (and pValues[r], counts[r * (nBins + 1) ..] when given) for nReplicas replicas.
+// nThreads <= 0 uses every core.
+inline void bootstrapChiSquare(const int32_t* bins, const int64_t* offsets, int64_t nEvents, const double* fractions,
+                               int nBins, int nReplicas, uint64_t seed, int nThreads, double* chi2, double* pValues,
+                               int64_t* counts) {
+    TaskPool pool(nThreads > 0 ? nThreads - 1 : TaskPool::helpersFor(std::max(nReplicas, 1)));
+    const Patterns patterns = collectPatterns(bins, offsets, nEvents, nBins, pool);
+
+    auto replica = [&](int r) {
+        std::mt19937_64 rng(seeds::splitmix64(seed ^ seeds::splitmix64(static_cast<uint64_t>(r))));
+        std::vector<int64_t> multiplicity(patterns.events.size());
+        std::vector<int64_t> local(nBins + 1);
+        resample(patterns, nEvents, rng, multiplicity.data());
+        int64_t* replicaCounts = counts ? counts + static_cast<int64_t>(r) * (nBins + 1) : local.data();
+        binCounts(patterns, multiplicity.data(), nBins, replicaCounts);
+        chi2[r] = chiSquare(replicaCounts, fractions, nBins, pValues ? pValues + r : nullptr);
+    };
+    pool.run(nReplicas, replica);
+}
+
+} // namespace stats
+
+#endif
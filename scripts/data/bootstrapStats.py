@@ -0,0 +1,121 @@
+import ctypes
+import os
+
+import numpy as np
+
+# ctypes wrapper of libbootstrapStats.so (bootstrapStats.cc), built by the Makefile into
+# build/<variant>/. HIGGS_STATS_LIB overrides the library path.
+
+LIBRARY_NAME = "libbootstrapStats.so"
+
+_int32_p = np.ctypeslib.ndpointer(np.int32, flags="C_CONTIGUOUS")
+_int64_p = np.ctypeslib.ndpointer(np.int64, flags="C_CONTIGUOUS")
+_double_p = np.ctypeslib.ndpointer(np.float64, flags="C_CONTIGUOUS")
+_lib = None
+
+
+def _optional(pointer_type):
+    """ndpointer argument that also accepts None"""
+    class Optional(pointer_type):
+        @classmethod
+        def from_param(cls, obj):
+            return obj if obj is None else pointer_type.from_param(obj)
+    return Optional
+
+
+def load_library():
+    global _lib
+    if _lib is not None:
+        return _lib
+    path = os.environ.get("HIGGS_STATS_LIB")
+    if not path:
+        build_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), "build")
+        candidates = [os.path.join(build_dir, variant, LIBRARY_NAME) for variant in ("release", "native", "lto", "pgo")]
+        path = next((c for c in candidates if os.path.exists(c)), None)
+        if path is None:
+            raise OSError(f"{LIBRARY_NAME} not found under {build_dir}; run make or set HIGGS_STATS_LIB")
+    lib = ctypes.CDLL(path)
+    lib.hs_bin_counts.argtypes = [_int32_p, _optional(_int64_p), ctypes.c_int64, ctypes.c_int32, _int64_p]
+    lib.hs_bin_counts.restype = ctypes.c_int
+    lib.hs_chi_square.argtypes = [_int64_p, _double_p, ctypes.c_int32, ctypes.POINTER(ctypes.c_double)]
+    lib.hs_chi_square.restype = ctypes.c_double
+    lib.hs_bootstrap_chi_square.argtypes = [_int32_p, _optional(_int64_p), ctypes.c_int64, _double_p, ctypes.c_int32,
+                                            ctypes.c_int32, ctypes.c_uint64, ctypes.c_int32, _double_p,
+                                            _optional(_double_p), _optional(_int64_p)]
+    lib.hs_bootstrap_chi_square.restype = ctypes.c_int
+    lib.hs_map_bins_f32.argtypes = [np.ctypeslib.ndpointer(np.float32), ctypes.c_int64, ctypes.c_int64,
+                                    np.ctypeslib.ndpointer(np.float32, flags="C_CONTIGUOUS"), ctypes.c_int32, _int32_p]
+    lib.hs_map_bins_f32.restype = ctypes.c_int64
+    _lib = lib
+    return lib
+
+
+def encode_events(event_labels, bin_names):
+    """Bin indices and CSR offsets of per-event label lists; labels not in bin_names go to "other" (-1)."""
+    index = {str(name): b for b, name in enumerate(bin_names)}
+    offsets = np.zeros(len(event_labels) + 1, dtype=np.int64)
+    bins = []
+    for e, labels in enumerate(event_labels):
+        bins.extend(index.get(str(label), -1) for label in labels)
+        offsets[e + 1] = len(bins)
+    return np.asarray(bins, dtype=np.int32), offsets
+
+
+def encode_labels(labels, bin_names):
+    """Bin indices of one label per event (a pandas Series); offsets are None"""
+    index = {str(name): b for b, name in enumerate(bin_names)}
+    return labels.astype(str).map(index).fillna(-1).to_numpy(dtype=np.int32), None
+
+
+def encode_matrix_column(matrix, column, bin_values):
+    """Bin indices of one column of a float32 feature matrix (e.g. np.load(..., mmap_mode="r")), without copying it"""
+    lib = load_library()
+    values = np.asarray(bin_values, dtype=np.float32)
+    bins = np.empty(matrix.shape[0], dtype=np.int32)
+    column_view = matrix[:, column]
+    stride = column_view.strides[0] // column_view.itemsize
+    lib.hs_map_bins_f32(column_view, matrix.shape[0], stride, values, len(values), bins)
+    return bins, None
+
+
+def bin_counts(bins, offsets, n_bins):
+    """Counts per bin, with the "other" bin last"""
+    n_events = len(bins) if offsets is None else len(offsets) - 1
+    counts = np.zeros(n_bins + 1, dtype=np.int64)
+    if load_library().hs_bin_counts(bins, offsets, n_events, n_bins, counts) != 0:
+        raise ValueError("invalid bin arrays")
+    return counts
+
+
+def chi_square(counts, fractions):
+    """Chi-square statistic and p-value of counts (with the "other" bin last) against expected fractions"""
+    p_value = ctypes.c_double()
+    chi2 = load_library().hs_chi_square(np.ascontiguousarray(counts, dtype=np.int64),
+                                        np.ascontiguousarray(fractions, dtype=np.float64), len(fractions),
+                                        ctypes.byref(p_value))
+    return chi2, p_value.value
+
+
+def bootstrap_chi_square(bins, offsets, fractions, replicas=1000, seed=0, threads=0, keep_counts=False):
+    """Chi-square and p-value of each bootstrap replica (and its counts if keep_counts); threads=0 uses every core"""
+    fractions = np.ascontiguousarray(fractions, dtype=np.float64)
+    n_events = len(bins) if offsets is None else len(offsets) - 1
+    chi2 = np.empty(replicas, dtype=np.float64)
+    p_values = np.empty(replicas, dtype=np.float64)
+    counts = np.empty((replicas, len(fractions) + 1), dtype=np.int64) if keep_counts else None
+    status = load_library().hs_bootstrap_chi_square(bins, offsets, n_events, fractions, len(fractions), replicas,
+                                                    seed, threads, chi2, p_values, counts)
+    if status != 0:
+        raise ValueError("invalid bootstrap arguments (no events?)")
+    return (chi2, p_values, counts) if keep_counts else (chi2, p_values)
+
+
+def report_bootstrap(bins, offsets, fractions, replicas, seed, threads=0):
+    """Prints the observed chi-square with its bootstrap spread"""
+    chi2_observed, p_observed = chi_square(bin_counts(bins, offsets, len(fractions)), fractions)
+    chi2, p_values = bootstrap_chi_square(bins, offsets, fractions, replicas, seed, threads)
+    low, high = np.percentile(chi2, [2.5, 97.5])
+    p_low, p_high = np.percentile(p_values, [2.5, 97.5])
+    print(f"Bootstrap ({replicas} replicas, seed {seed}):")
+    print(f"  Chi-Square Statistic: {chi2_observed} +- {chi2.std(ddof=1)} (95% interval {low} - {high})")
+    print(f"  P-value: {p_observed} (95% interval {p_low} - {p_high})")
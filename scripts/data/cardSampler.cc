@@ -0,0 +1,217 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "coefficientDesign.h"
+#include "featureMatrix.h"
+
+// Writes a batch of MadGraph runs over the Wilson coefficient space in one call: one directory
+// per design point (see coefficientDesign.h) holding its param_card.dat, run_card.dat,
+// wilson_coefficients.json (for training_smeft100 --coefficients) and a madgraph.txt launch
+// script, so the points can be generated in parallel instead of rewriting one param_card in
+// place per iteration. The points are appended to <out_dir>/design.csv.
+
+struct SamplerOptions {
+    std::string paramCard, runCard, outDir;
+    std::string design = "sobol";
+    int nPoints = 64;
+    uint64_t first = 0;       // Index of the first point; for Sobol, continues an earlier batch
+    uint64_t seed = 0;
+    bool seedGiven = false;
+    bool scramble = true;     // Sobol digital shift
+    int candidates = 16;      // Latin hypercubes tried
+    double minValue = -10, maxValue = 10;
+    long nEvents = 10000;
+    std::string ebeam = "50000";
+    std::string process = "SMEFT_run3";
+};
+
+bool parseSamplerOptions(int argc, char* argv[], SamplerOptions& options) {
+    if (argc < 4) return false;
+    options.paramCard = argv[1];
+    options.runCard = argv[2];
+    options.outDir = argv[3];
+    for (int i = 4; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--design" && hasValue) {
+            options.design = argv[++i];
+        } else if (arg == "--points" && hasValue) {
+            options.nPoints = std::atoi(argv[++i]);
+        } else if (arg == "--first" && hasValue) {
+            options.first = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+            options.seedGiven = true;
+        } else if (arg == "--no-scramble") {
+            options.scramble = false;
+        } else if (arg == "--candidates" && hasValue) {
+            options.candidates = std::atoi(argv[++i]);
+        } else if (arg == "--range" && hasValue) {
+            std::string range = argv[++i];
+            size_t colon = range.find(':', 1);
+            if (colon == std::string::npos) return false;
+            options.minValue = std::atof(range.substr(0, colon).c_str());
+            options.maxValue = std::atof(range.substr(colon + 1).c_str());
+        } else if (arg == "--nevents" && hasValue) {
+            options.nEvents = std::atol(argv[++i]);
+        } else if (arg == "--ebeam" && hasValue) {
+            options.ebeam = argv[++i];
+        } else if (arg == "--process" && hasValue) {
+            options.process = argv[++i];
+        } else {
+            std::cerr << "Error: Unknown or incomplete option " << arg << std::endl;
+            return false;
+        }
+    }
+    if (options.design != "sobol" && options.design != "lhs") {
+        std::cerr << "Error: --design must be sobol or lhs" << std::endl;
+        return false;
+    }
+    if (options.nPoints <= 0 || options.maxValue <= options.minValue) return false;
+    return true;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <param_card> <run_card> <out_dir> [options]" << std::endl;
+    std::cerr << "  --design sobol|lhs   Sobol sequence (default) or Latin hypercube" << std::endl;
+    std::cerr << "  --points N           Points in this batch (default 64; powers of two suit Sobol)" << std::endl;
+    std::cerr << "  --first K            Index of the first point (Sobol: sequence index, to extend an earlier batch; default 0)" << std::endl;
+    std::cerr << "  --seed S             Sobol digital shift / Latin hypercube seed (default: random, printed)" << std::endl;
+    std::cerr << "  --no-scramble        Plain Sobol sequence without the digital shift" << std::endl;
+    std::cerr << "  --candidates K       Latin hypercubes tried, the lowest-discrepancy one is kept (default 16)" << std::endl;
+    std::cerr << "  --range MIN:MAX      Coefficient range (default -10:10)" << std::endl;
+    std::cerr << "  --nevents N          nevents of every run_card (default 10000)" << std::endl;
+    std::cerr << "  --ebeam E            ebeam1/ebeam2 of every run_card in GeV (default 50000)" << std::endl;
+    std::cerr << "  --process DIR        MadGraph process directory launched (default SMEFT_run3)" << std::endl;
+}
+
+bool writePoint(const SamplerOptions& options, const std::string& dir, const std::string& runName, uint64_t index,
+                const std::vector<double>& coefficients, const std::vector<std::string>& paramTemplate,
+                const std::vector<std::string>& runTemplate) {
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+    if (error) {
+        std::cerr << "Error: Could not create directory " << dir << ": " << error.message() << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> paramCard = paramTemplate;
+    design::setSmeftBlock(paramCard, coefficients);
+
+    // Distinct MadGraph seed per point, reproducible from (seed, index)
+    std::vector<std::string> runCard = runTemplate;
+    design::setRunCardValue(runCard, "nevents", std::to_string(options.nEvents));
+    design::setRunCardValue(runCard, "ebeam1", options.ebeam);
+    design::setRunCardValue(runCard, "ebeam2", options.ebeam);
+    design::setRunCardValue(runCard, "iseed", std::to_string(seeds::eventSeed(options.seed, index)));
+
+    // Same layout as coefficientUpdate.py's save_coefficients
+    std::vector<std::string> json(1, "{");
+    char entry[64];
+    for (size_t c = 0; c < coefficients.size(); c++) {
+        std::snprintf(entry, sizeof(entry), "  \"%zu\": %.17g%s", c + 1, coefficients[c], c + 1 < coefficients.size() ? "," : "");
+        json.push_back(entry);
+    }
+    json.push_back("}");
+
+    // MadGraph runs from its own directory, so the cards are given by absolute path
+    const std::string cards = std::filesystem::absolute(dir).string();
+    std::vector<std::string> launch = {
+        "launch " + options.process + " -n " + runName,
+        "shower=OFF",
+        "decay=ALL",
+        "done",
+        cards + "/param_card.dat",
+        cards + "/run_card.dat",
+        "done",
+        "quit",
+    };
+
+    return design::writeTextFile(dir + "/param_card.dat", paramCard) &&
+           design::writeTextFile(dir + "/run_card.dat", runCard) &&
+           design::writeTextFile(dir + "/wilson_coefficients.json", json) &&
+           design::writeTextFile(dir + "/madgraph.txt", launch);
+}
+
+int main(int argc, char* argv[]) {
+    SamplerOptions options;
+    if (!parseSamplerOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (!options.seedGiven) options.seed = seeds::randomRunSeed();
+
+    std::vector<std::string> paramTemplate, runTemplate;
+    if (!design::readTextFile(options.paramCard, paramTemplate) || !design::readTextFile(options.runCard, runTemplate)) {
+        return 1;
+    }
+    std::vector<std::string> probe = paramTemplate;
+    if (design::setSmeftBlock(probe, std::vector<double>(kSmeftCoefficients, 0.0)) != kSmeftCoefficients) {
+        std::cerr << "Error: " << options.paramCard << " has no BLOCK SMEFT entries 1.." << kSmeftCoefficients << std::endl;
+        return 1;
+    }
+    probe = runTemplate;
+    for (const char* key : {"nevents", "ebeam1", "ebeam2", "iseed"}) {
+        if (!design::setRunCardValue(probe, key, "0")) {
+            std::cerr << "Error: " << options.runCard << " has no '= " << key << "' line" << std::endl;
+            return 1;
+        }
+    }
+
+    const int dims = kSmeftCoefficients;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<double> unit = (options.design == "sobol")
+        ? design::sobolDesign(dims, options.first, options.nPoints, options.scramble ? options.seed : 0)
+        : design::latinHypercubeDesign(dims, options.nPoints, options.seed, options.candidates);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Space-filling quality against independent uniform draws of the same size
+    double discrepancy = design::centeredDiscrepancy(unit, dims);
+    double uniformDiscrepancy = design::centeredDiscrepancy(design::uniformDesign(dims, options.nPoints, options.seed), dims);
+    std::cout << "Run seed: " << options.seed << std::endl;
+    std::cout << options.nPoints << " " << options.design << " points in " << dims << " dimensions in " << seconds
+              << " s, centered L2 discrepancy^2 " << discrepancy << " (uniform random: " << uniformDiscrepancy << ")"
+              << std::endl;
+
+    const std::string designFile = options.outDir + "/design.csv";
+    std::error_code error;
+    std::filesystem::create_directories(options.outDir, error);
+    bool newDesign = !std::filesystem::exists(designFile);
+    std::ofstream designOut(designFile, std::ios::app);
+    if (!designOut.is_open()) {
+        std::cerr << "Error: Could not open file for writing: " << designFile << std::endl;
+        return 1;
+    }
+    designOut.precision(17);
+    if (newDesign) {
+        designOut << "Point,Directory";
+        for (int c = 1; c <= dims; c++) designOut << ",c" << c;
+        designOut << "\n";
+    }
+
+    std::vector<double> coefficients(dims);
+    char name[32];
+    for (int i = 0; i < options.nPoints; i++) {
+        uint64_t index = options.first + i;
+        std::snprintf(name, sizeof(name), "point_%05llu", static_cast<unsigned long long>(index));
+        for (int d = 0; d < dims; d++) {
+            coefficients[d] = options.minValue + (options.maxValue - options.minValue) * unit[static_cast<size_t>(i) * dims + d];
+        }
+        const std::string dir = options.outDir + "/" + name;
+        if (!writePoint(options, dir, name, index, coefficients, paramTemplate, runTemplate)) return 1;
+        designOut << index << "," << dir;
+        for (double c : coefficients) designOut << "," << c;
+        designOut << "\n";
+    }
+
+    std::cout << "Wrote " << options.nPoints << " card directories under " << options.outDir << " (points "
+              << options.first << ".." << options.first + options.nPoints - 1 << ")" << std::endl;
+    if (options.design == "sobol") {
+        std::cout << "Extend with --first " << options.first + options.nPoints << " --seed " << options.seed << std::endl;
+    }
+    return 0;
+}
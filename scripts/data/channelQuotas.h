@@ -0,0 +1,70 @@
+#ifndef CHANNEL_QUOTAS_H
+#define CHANNEL_QUOTAS_H
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Per-channel event quotas (--quota): instead of one inclusive run, in which gg -> H (902) is
+// ~86% of the events and ttH (908/909) well under 1%, every requested HiggsSM process runs as
+// its own sub-run with only that process switched on, for exactly its quota of events. The
+// quotas are so reached with their sum as the total event count. Each sub-run's rows carry the
+// event weight sigma_c / N_c (pb), so summing weights over the merged output reproduces the
+// inclusive mixture and cross section.
+
+struct ChannelQuota {
+    int code;      // HiggsSM process code (901..909), 0 = every process enabled in the generator
+    long nEvents;
+};
+
+struct HiggsProcess {
+    int code;
+    const char* setting;
+};
+
+// Standard Model Higgs processes covered by HiggsSM:all, by Pythia process code
+const HiggsProcess kHiggsProcesses[] = {
+    {901, "HiggsSM:ffbar2H"},
+    {902, "HiggsSM:gg2H"},
+    {903, "HiggsSM:gmgm2H"},
+    {904, "HiggsSM:ffbar2HZ"},
+    {905, "HiggsSM:ffbar2HW"},
+    {906, "HiggsSM:ff2Hff(t:ZZ)"},
+    {907, "HiggsSM:ff2Hff(t:WW)"},
+    {908, "HiggsSM:gg2Httbar"},
+    {909, "HiggsSM:qqbar2Httbar"},
+};
+
+inline const char* higgsProcessSetting(int code) {
+    for (const HiggsProcess& process : kHiggsProcesses) {
+        if (process.code == code) return process.setting;
+    }
+    return nullptr;
+}
+
+// "902:1000,909:1000" or "all:1000"
+inline bool parseChannelQuotas(const std::string& text, std::vector<ChannelQuota>& quotas) {
+    quotas.clear();
+    std::stringstream items(text);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        size_t colon = item.find(':');
+        if (colon == std::string::npos) return false;
+        ChannelQuota quota;
+        std::string code = item.substr(0, colon), events = item.substr(colon + 1);
+        char* end = nullptr;
+        if (code == "all") {
+            quota.code = 0;
+        } else {
+            quota.code = static_cast<int>(std::strtol(code.c_str(), &end, 10));
+            if (*end != '\0' || !higgsProcessSetting(quota.code)) return false;
+        }
+        quota.nEvents = std::strtol(events.c_str(), &end, 10);
+        if (events.empty() || *end != '\0' || quota.nEvents <= 0) return false;
+        quotas.push_back(quota);
+    }
+    return !quotas.empty();
+}
+
+#endif
@@ -35,6 +35,24 @@ def get_production_channel_bins(filtered_data):
 def get_jet_bins(filtered_data):
     return filtered_data['Jet_ID'].value_counts()
 
+def get_event_labels(filtered_data, bin_type):
+    """Per-event bin labels for the bootstrap, which resamples events rather than bin entries"""
+    if bin_type == "decay_products":
+        decay_pairs = filtered_data['DecayProducts'].str.split(';')
+        return [[f"{decay[i]};{decay[i+1]}" for i in range(0, len(decay)-1, 2)] for decay in decay_pairs]
+    return None
+
+def bootstrap_chi_square(observed_filtered, expected_ratios, bin_type, bootstrap):
+    import bootstrapStats
+    bin_names = list(expected_ratios.keys())
+    fractions = [expected_ratios[name] for name in bin_names]
+    event_labels = get_event_labels(observed_filtered, bin_type)
+    if event_labels is None:
+        bins, offsets = bootstrapStats.encode_labels(observed_filtered['ProductionChannel'], bin_names)
+    else:
+        bins, offsets = bootstrapStats.encode_events(event_labels, bin_names)
+    bootstrapStats.report_bootstrap(bins, offsets, fractions, bootstrap["replicas"], bootstrap["seed"], bootstrap["threads"])
+
 def calculate_chi_square(observed_bins, expected_ratios, filter_value):
     total_observed = sum(observed_bins)
     print(f"Total Observed: {total_observed}...")
@@ -88,7 +106,7 @@ def calculate_chi_square(observed_bins, expected_ratios, filter_value):
     print(f"Chi-Square Statistic: {chi2}")
     print(f"P-value: {p}")
 
-def main(observed_file, filter_type, filter_value):
+def main(observed_file, filter_type, filter_value, bootstrap=None):
     observed_data = pd.read_csv(observed_file)
     filter_value = str(filter_value) 
 
@@ -147,28 +165,44 @@ def main(observed_file, filter_type, filter_value):
 
     # Perform chi-square goodness of fit test
     if filter_type == "production_channel":
-        calculate_chi_square(observed_bins, expected_ratios["decay_products"], filter_value)
+        bin_type = "decay_products"
         
     elif filter_type == "decay_products":
-        calculate_chi_square(observed_bins, expected_ratios["production_channel"], filter_value)
+        bin_type = "production_channel"
 
     else:
         if filter_value == "0":
-            calculate_chi_square(observed_bins, expected_ratios["production_channel"], filter_value)
+            bin_type = "production_channel"
         elif filter_value == "1":
-            calculate_chi_square(observed_bins, expected_ratios["decay_products"], filter_value)
+            bin_type = "decay_products"
         else:
             print("Invalid filter value. Use 0 for production channel bins, or 1 for decay product bins.")
             sys.exit(1)
 
+    calculate_chi_square(observed_bins, expected_ratios[bin_type], filter_value)
+    if bootstrap:
+        bootstrap_chi_square(observed_filtered, expected_ratios[bin_type], bin_type, bootstrap)
+
+def parse_bootstrap_options(args):
+    """--bootstrap <replicas> [--seed <seed>] [--threads <threads>]; None without --bootstrap"""
+    options = {"replicas": 0, "seed": 20240601, "threads": 0}
+    names = {"--bootstrap": "replicas", "--seed": "seed", "--threads": "threads"}
+    if len(args) % 2 != 0 or any(args[i] not in names for i in range(0, len(args), 2)):
+        return False
+    for i in range(0, len(args), 2):
+        options[names[args[i]]] = int(args[i + 1])
+    return options if options["replicas"] > 0 else None
+
 if __name__ == "__main__":
-    if len(sys.argv) < 4 or len(sys.argv) > 4:
-        print("Usage: python chisquare.py <observed_file> <filter_type> <filter_value>")
+    bootstrap = parse_bootstrap_options(sys.argv[4:])
+    if len(sys.argv) < 4 or bootstrap is False:
+        print("Usage: python chisquare.py <observed_file> <filter_type> <filter_value> [--bootstrap <replicas> [--seed <seed>] [--threads <threads>]]")
         print("filter_type: 'production_channel', 'decay_products', or 'jet_stats'")
         print("filter_value: the value for filtering (e.g., 902 or '5;-5')")
+        print("--bootstrap: chi-square spread over resampled events (libbootstrapStats.so, see bootstrapStats.py)")
         sys.exit(1)
 
     observed_file = sys.argv[1]
     filter_type = sys.argv[2]
     filter_value = sys.argv[3]
-    main(observed_file, filter_type, filter_value)
+    main(observed_file, filter_type, filter_value, bootstrap)
@@ -0,0 +1,240 @@
+#ifndef COEFFICIENT_DESIGN_H
+#define COEFFICIENT_DESIGN_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "eventSeeds.h"
+
+// Space-filling designs over the Wilson coefficient space, replacing the independent uniform
+// draws of coefficientUpdate.py. Points are in the unit cube [0,1)^d and scaled to the
+// coefficient range by the caller.
+//   Sobol: the low-discrepancy sequence with the Joe-Kuo direction numbers
+//          (new-joe-kuo-6.21201). It is extensible, so a sweep can be continued batch by batch
+//          from any index and the union stays low-discrepancy; best at power-of-two sizes.
+//          An optional random digital shift (XOR of one random word per dimension) keeps the
+//          structure while giving independent replicas per seed.
+//   Latin hypercube: every one of the N equal strata of every coordinate holds exactly one
+//          point; of several random candidates the one with the lowest discrepancy is kept.
+namespace design {
+
+const int kSobolBits = 32;
+const int kSobolMaxDimensions = 16;
+
+// Joe-Kuo primitive polynomials (degree s, coefficients a) and initial direction numbers m_1..m_s
+// for dimensions 2..16; dimension 1 is the van der Corput sequence
+struct SobolPolynomial {
+    int s;
+    unsigned a;
+    unsigned m[8];
+};
+
+const SobolPolynomial kSobolPolynomials[kSobolMaxDimensions - 1] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+};
+
+class Sobol {
+public:
+    // shiftSeed = 0: the plain sequence, starting with the origin at index 0
+    Sobol(int dimensions, uint64_t shiftSeed = 0) : dims(dimensions), directions(dimensions), shift(dimensions, 0) {
+        for (int k = 0; k < kSobolBits; k++) directions[0][k] = uint32_t(1) << (kSobolBits - 1 - k);
+        for (int d = 1; d < dims; d++) {
+            const SobolPolynomial& p = kSobolPolynomials[d - 1];
+            std::array<uint32_t, kSobolBits>& v = directions[d];
+            for (int k = 0; k < p.s; k++) v[k] = p.m[k] << (kSobolBits - 1 - k);
+            for (int k = p.s; k < kSobolBits; k++) {
+                v[k] = v[k - p.s] ^ (v[k - p.s] >> p.s);
+                for (int j = 1; j < p.s; j++) {
+                    if ((p.a >> (p.s - 1 - j)) & 1) v[k] ^= v[k - j];
+                }
+            }
+        }
+        if (shiftSeed != 0) {
+            for (int d = 0; d < dims; d++) shift[d] = static_cast<uint32_t>(seeds::splitmix64(shiftSeed ^ seeds::splitmix64(d)));
+        }
+    }
+
+    // Point `index` of the sequence (Gray-code order, as in Joe and Kuo's generator)
+    void point(uint64_t index, double* x) const {
+        uint64_t gray = index ^ (index >> 1);
+        for (int d = 0; d < dims; d++) {
+            uint32_t bits = shift[d];
+            for (int k = 0; k < kSobolBits && (gray >> k); k++) {
+                if ((gray >> k) & 1) bits ^= directions[d][k];
+            }
+            x[d] = bits * (1.0 / 4294967296.0);
+        }
+    }
+
+private:
+    int dims;
+    std::vector<std::array<uint32_t, kSobolBits>> directions;
+    std::vector<uint32_t> shift;
+};
+
+// nPoints x dimensions, row-major
+inline std::vector<double> sobolDesign(int dimensions, uint64_t first, int nPoints, uint64_t shiftSeed) {
+    Sobol sobol(dimensions, shiftSeed);
+    std::vector<double> points(static_cast<size_t>(nPoints) * dimensions);
+    for (int i = 0; i < nPoints; i++) sobol.point(first + i, &points[static_cast<size_t>(i) * dimensions]);
+    return points;
+}
+
+inline std::vector<double> uniformDesign(int dimensions, int nPoints, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<double> points(static_cast<size_t>(nPoints) * dimensions);
+    for (double& x : points) x = uniform(rng);
+    return points;
+}
+
+// Squared centered L2 discrepancy (Hickernell 1998), lower is more uniform. O(N^2 d).
+inline double centeredDiscrepancy(const std::vector<double>& points, int dimensions) {
+    const size_t n = points.size() / dimensions;
+    if (n == 0) return 0.0;
+    std::vector<double> centered(points.size());
+    for (size_t i = 0; i < points.size(); i++) centered[i] = std::fabs(points[i] - 0.5);
+
+    double single = 0.0, pairs = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        const double* ci = &centered[i * dimensions];
+        const double* xi = &points[i * dimensions];
+        double product = 1.0;
+        for (int d = 0; d < dimensions; d++) product *= 1.0 + 0.5 * ci[d] - 0.5 * ci[d] * ci[d];
+        single += product;
+        // Symmetric in (i, j): diagonal once, off-diagonal twice
+        for (size_t j = i; j < n; j++) {
+            const double* cj = &centered[j * dimensions];
+            const double* xj = &points[j * dimensions];
+            double term = 1.0;
+            for (int d = 0; d < dimensions; d++) term *= 1.0 + 0.5 * ci[d] + 0.5 * cj[d] - 0.5 * std::fabs(xi[d] - xj[d]);
+            pairs += (j == i) ? term : 2.0 * term;
+        }
+    }
+    return std::pow(13.0 / 12.0, dimensions) - 2.0 / n * single + pairs / (double(n) * n);
+}
+
+// Best of `candidates` random Latin hypercubes by centered discrepancy
+inline std::vector<double> latinHypercubeDesign(int dimensions, int nPoints, uint64_t seed, int candidates) {
+    std::vector<double> best;
+    double bestDiscrepancy = 0.0;
+    std::vector<int> strata(nPoints);
+    for (int c = 0; c < std::max(1, candidates); c++) {
+        std::mt19937_64 rng(seeds::splitmix64(seed ^ seeds::splitmix64(c)));
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::vector<double> points(static_cast<size_t>(nPoints) * dimensions);
+        for (int d = 0; d < dimensions; d++) {
+            std::iota(strata.begin(), strata.end(), 0);
+            std::shuffle(strata.begin(), strata.end(), rng);
+            for (int i = 0; i < nPoints; i++) {
+                points[static_cast<size_t>(i) * dimensions + d] = (strata[i] + uniform(rng)) / nPoints;
+            }
+        }
+        if (candidates <= 1) return points;
+        double discrepancy = centeredDiscrepancy(points, dimensions);
+        if (best.empty() || discrepancy < bestDiscrepancy) {
+            best.swap(points);
+            bestDiscrepancy = discrepancy;
+        }
+    }
+    return best;
+}
+
+// MadGraph param_card / run_card rewriting, as coefficientUpdate.py does for a single point
+
+inline bool readTextFile(const std::string& path, std::vector<std::string>& lines) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "Error: Could not open file: " << path << std::endl;
+        return false;
+    }
+    lines.clear();
+    std::string line;
+    while (std::getline(in, line)) lines.push_back(line);
+    return true;
+}
+
+inline bool writeTextFile(const std::string& path, const std::vector<std::string>& lines) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open file for writing: " << path << std::endl;
+        return false;
+    }
+    for (const std::string& line : lines) out << line << '\n';
+    return static_cast<bool>(out);
+}
+
+inline std::string upperWord(std::istringstream& fields) {
+    std::string word;
+    fields >> word;
+    std::transform(word.begin(), word.end(), word.begin(), ::toupper);
+    return word;
+}
+
+// param_card with entries 1..coefficients.size() of BLOCK SMEFT set, keeping each entry's comment.
+// Returns the number of entries replaced.
+inline int setSmeftBlock(std::vector<std::string>& card, const std::vector<double>& coefficients) {
+    int replaced = 0;
+    bool inBlock = false;
+    char value[32];
+    for (std::string& line : card) {
+        std::istringstream fields(line);
+        std::string first = upperWord(fields);
+        if (first == "BLOCK" || first == "DECAY") {
+            inBlock = (first == "BLOCK" && upperWord(fields) == "SMEFT");
+            continue;
+        }
+        if (!inBlock || first.empty() || first[0] == '#') continue;
+        char* end = nullptr;
+        long index = std::strtol(first.c_str(), &end, 10);
+        if (*end != '\0' || index < 1 || index > static_cast<long>(coefficients.size())) continue;
+        size_t comment = line.find('#');
+        std::snprintf(value, sizeof(value), "%.6e", coefficients[index - 1]);
+        line = "    " + first + " " + value + (comment == std::string::npos ? "" : " " + line.substr(comment));
+        replaced++;
+    }
+    return replaced;
+}
+
+// run_card line "<value> = <key> ! <comment>" with a new value; false if the key is missing
+inline bool setRunCardValue(std::vector<std::string>& card, const std::string& key, const std::string& value) {
+    for (std::string& line : card) {
+        size_t start = line.find_first_not_of(" \t");
+        size_t equals = line.find('=');
+        if (start == std::string::npos || line[start] == '#' || equals == std::string::npos || equals == start) continue;
+        std::istringstream fields(line.substr(equals + 1));
+        std::string name;
+        fields >> name;
+        if (name != key) continue;
+        line = "     " + value + " " + line.substr(equals);
+        return true;
+    }
+    return false;
+}
+
+} // namespace design
+
+#endif
@@ -1,3 +1,6 @@
+# Single random point per call, rewriting the MadGraph cards in place; for batches of
+# space-filling points with their own card directories see cardSampler.cc
+
 import random
 import json
 
@@ -0,0 +1,74 @@
+import os
+import re
+import subprocess
+import sys
+
+# Runs one generator from each build variant of the Makefile (build/<variant>/) with the same seed
+# and event count, and reports the events/s each prints, relative to the release build.
+
+VARIANTS = ["release", "lto", "native", "pgo"]
+RATE_PATTERN = re.compile(r"([0-9.eE+-]+) events/s")
+
+
+def run_variant(binary, args):
+    result = subprocess.run([binary] + args, capture_output=True, text=True)
+    if result.returncode != 0:
+        print(f"{binary} failed with exit code {result.returncode}")
+        return None
+    rates = RATE_PATTERN.findall(result.stdout)
+    return float(rates[-1]) if rates else None
+
+
+def compare(program, n_events, seed, repeats, extra_args):
+    build_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), "build")
+    rates = {}
+    for variant in VARIANTS:
+        binary = os.path.join(build_dir, variant, program)
+        if not os.path.exists(binary):
+            continue
+        output = os.path.join(build_dir, variant, f"compare-{program}.csv")
+        if program == "training_smeft100":
+            args = extra_args[:1] + [output, "--events", f"0:{n_events}"] + extra_args[1:]
+        elif program == "tevmain":
+            energy = extra_args[0] if extra_args else "13"
+            args = [f"{energy}:{n_events}:{output}", "--seed", str(seed)] + extra_args[1:]
+        else:
+            args = [output, "--seed", str(seed), "--nevents", str(n_events)] + extra_args
+        runs = [run_variant(binary, args) for _ in range(repeats)]
+        runs = [rate for rate in runs if rate is not None]
+        if os.path.exists(output):
+            os.remove(output)
+        if runs:
+            rates[variant] = max(runs)
+
+    if not rates:
+        print(f"No built variants of {program} under {build_dir}; run make first")
+        return 1
+
+    baseline = rates.get("release")
+    print(f"{program}: {n_events} events, seed {seed}, best of {repeats}")
+    print(f"{'Variant':<10}{'Events/s':>12}{'vs release':>12}")
+    for variant, rate in rates.items():
+        speedup = f"{rate / baseline:.3f}x" if baseline else "-"
+        print(f"{variant:<10}{rate:>12.1f}{speedup:>12}")
+    return 0
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print("Usage: python compareBuilds.py <program> [n_events=500] [seed=20240601] [repeats=3] [-- extra args]")
+        print("       training_smeft100 takes its LHE file as the first extra argument,")
+        print("       tevmain the collision energy in TeV (default 13)")
+        sys.exit(1)
+
+    extra = []
+    argv = sys.argv[1:]
+    if "--" in argv:
+        extra = argv[argv.index("--") + 1:]
+        argv = argv[:argv.index("--")]
+
+    program = argv[0]
+    n_events = int(argv[1]) if len(argv) > 1 else 500
+    seed = int(argv[2]) if len(argv) > 2 else 20240601
+    repeats = int(argv[3]) if len(argv) > 3 else 3
+    sys.exit(compare(program, n_events, seed, repeats, extra))
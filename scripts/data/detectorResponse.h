@@ -0,0 +1,319 @@
+#ifndef DETECTOR_RESPONSE_H
+#define DETECTOR_RESPONSE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "fastjet/ClusterSequence.hh"
+#include "eventSnapshot.h"
+#include "eventSeeds.h"
+#include "kinematicsKernels.h"
+
+// Parametrized detector response applied to the final state before jet clustering (--detector):
+// invisibles (neutrinos, neutralinos, gravitons) are removed, every particle class has its own
+// acceptance and Gaussian resolution, and calorimeter-only deposits can optionally be merged
+// into eta-phi towers, particle-flow style, with tracks, electrons and muons kept separate.
+//   tracks (charged hadrons, muons)   sigma(pT)/pT = a (+) b pT        within trackEta / muonEta
+//   ECAL (electrons, photons)         sigma(E)/E   = a / sqrt(E) (+) c within ecalEta
+//   HCAL (neutral hadrons, charged    sigma(E)/E   = a / sqrt(E) (+) c within hcalEta
+//         hadrons beyond the tracker)
+// Smearing scales the whole four-vector, keeping its direction. The Gaussian draws of an event
+// come from its own stream seeded with (seed, event index), so a replayed event gets the same
+// response. The seed follows the run (the generators' run seed, training_smeft100's input file)
+// unless seed=<n> fixes it. pT and eta of the batch go through the kinematics kernels, and the smearing itself
+// is a plain loop over the SoA batch that the compiler vectorizes.
+namespace detector {
+
+struct Config {
+    bool enabled = false;
+    double trackEta = 2.5, trackPtMin = 0.5, trackA = 0.01, trackB = 1e-4;
+    double muonEta = 2.7, muonPtMin = 3.0, muonA = 0.01, muonB = 1e-4;
+    double ecalEta = 3.0, ecalEMin = 0.5, ecalA = 0.10, ecalC = 0.01;
+    double hcalEta = 4.9, hcalEMin = 1.0, hcalA = 0.50, hcalC = 0.05;
+    double towerSize = 0.0; // Eta-phi tower size for merging calorimeter deposits, 0 = no merging
+    uint64_t seed = 20240601;
+    bool fixedSeed = false; // seed=<n> given; otherwise the program sets seed per run
+};
+
+// "generic" (the defaults above) or "generic,<key>=<value>,...", e.g. generic,towers=0.1,hcalA=0.8
+inline bool parseDetectorConfig(const std::string& spec, Config& config) {
+    config = Config();
+    config.enabled = true;
+    std::stringstream items(spec);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        if (item == "generic") continue;
+        if (item == "none") {
+            config.enabled = false;
+            continue;
+        }
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) return false;
+        std::string key = item.substr(0, equals), value = item.substr(equals + 1);
+        char* end = nullptr;
+        double number = std::strtod(value.c_str(), &end);
+        if (value.empty() || *end != '\0' || number < 0) return false;
+        struct Parameter {
+            const char* key;
+            double* value;
+        };
+        const Parameter parameters[] = {
+            {"trackEta", &config.trackEta}, {"trackPtMin", &config.trackPtMin},
+            {"trackA", &config.trackA}, {"trackB", &config.trackB},
+            {"muonEta", &config.muonEta}, {"muonPtMin", &config.muonPtMin},
+            {"muonA", &config.muonA}, {"muonB", &config.muonB},
+            {"ecalEta", &config.ecalEta}, {"ecalEMin", &config.ecalEMin},
+            {"ecalA", &config.ecalA}, {"ecalC", &config.ecalC},
+            {"hcalEta", &config.hcalEta}, {"hcalEMin", &config.hcalEMin},
+            {"hcalA", &config.hcalA}, {"hcalC", &config.hcalC},
+            {"towers", &config.towerSize},
+        };
+        bool known = false;
+        for (const Parameter& parameter : parameters) {
+            if (key == parameter.key) {
+                *parameter.value = number;
+                known = true;
+            }
+        }
+        if (key == "seed") {
+            config.seed = std::strtoull(value.c_str(), nullptr, 10);
+            config.fixedSeed = true;
+            known = true;
+        }
+        if (!known) {
+            std::cerr << "Error: Unknown detector parameter '" << key << "'" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Three times the electric charge, from the PDG code alone so that it also works on replayed
+// event caches: leptons, gauge bosons and quark-content hadrons (mesons 0 q2 q3 carry an up-type
+// q2 as quark and a down-type q2 as antiquark)
+inline int chargeTimes3(int id) {
+    static const int quark3[7] = {0, -1, 2, -1, 2, -1, 2};
+    const int sign = (id > 0) ? 1 : -1;
+    const int a = std::abs(id) % 10000;
+    if (a == 11 || a == 13 || a == 15 || a == 17) return -3 * sign;
+    if (a == 24 || a == 37) return 3 * sign;
+    if (a >= 1 && a <= 6) return quark3[a] * sign;
+    const int q1 = (a / 1000) % 10, q2 = (a / 100) % 10, q3 = (a / 10) % 10;
+    if (a < 100 || q2 > 6 || q3 > 6 || q3 == 0) return 0;
+    if (q1 == 0) {
+        const int charge = (q2 % 2 == 0) ? quark3[q2] - quark3[q3] : quark3[q3] - quark3[q2];
+        return charge * sign;
+    }
+    if (q1 > 6) return 0;
+    return (quark3[q1] + quark3[q2] + quark3[q3]) * sign;
+}
+
+enum class Kind : int8_t { Dropped, Track, Muon, Electron, Photon, Hcal };
+
+inline bool isInvisible(int id) {
+    const int a = std::abs(id);
+    return a == 12 || a == 14 || a == 16 || a == 18 || a == 39 || a == 1000022 || a == 1000039;
+}
+
+// Detector-level final state of an event as FastJet input, reusing its buffers between events
+class Response {
+public:
+    explicit Response(const Config& configIn = Config()) : config(configIn) {
+        if (config.enabled && config.towerSize > 0) {
+            const double etaMax = std::max(config.ecalEta, config.hcalEta);
+            nEtaHalf = std::max(1, static_cast<int>(std::ceil(etaMax / config.towerSize)));
+            nPhi = std::max(1, static_cast<int>(std::lround(2 * kin::kPi / config.towerSize)));
+            towerSlot.assign(static_cast<size_t>(2 * nEtaHalf) * nPhi, -1);
+        }
+    }
+
+    bool enabled() const { return config.enabled; }
+    const Config& settings() const { return config; }
+
+    // Particles in and out of the response, summed over fill() calls
+    long particlesIn() const { return nIn; }
+    long particlesOut() const { return nOut; }
+
+    // With towers, (member, representative) pairs of event indices: member was merged into the
+    // tower whose user_index is representative, so it belongs to the same jet
+    const std::vector<std::pair<int, int>>& aliases() const { return merged; }
+
+    // user_index of every output is the event index of the (leading) particle it came from.
+    // Without a configured detector this is fillPseudoJets().
+    void fill(const EventSnapshot& snap, long eventKey, std::vector<fastjet::PseudoJet>& particles) {
+        merged.clear();
+        if (!config.enabled) {
+            fillPseudoJets(snap, particles);
+            return;
+        }
+        particles.clear();
+        batch.clear();
+        index.clear();
+        for (int k : snap.finalState) {
+            if (isInvisible(snap.id[k])) continue;
+            batch.push(snap.px[k], snap.py[k], snap.pz[k], snap.e[k]);
+            index.push_back(k);
+        }
+        nIn += static_cast<long>(snap.finalState.size());
+        const size_t n = batch.size();
+        pt.resize(n);
+        eta.resize(n);
+        kin::ptBatch(batch.px.data(), batch.py.data(), pt.data(), n);
+        kin::etaBatch(batch.px.data(), batch.py.data(), batch.pz.data(), eta.data(), n);
+
+        // Acceptance and relative resolution per particle, compacted to the accepted ones
+        size_t kept = 0;
+        kind.resize(n);
+        sigma.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            const int id = snap.id[index[i]];
+            const double absEta = std::fabs(eta[i]), energy = batch.e[i];
+            Kind k = Kind::Dropped;
+            double resolution = 0.0;
+            const int absId = std::abs(id);
+            if (absId == 13) {
+                if (absEta < config.muonEta && pt[i] > config.muonPtMin) {
+                    k = Kind::Muon;
+                    resolution = std::hypot(config.muonA, config.muonB * pt[i]);
+                }
+            } else if (absId == 11 || absId == 22) {
+                if (absEta < config.ecalEta && energy > config.ecalEMin) {
+                    k = (absId == 11) ? Kind::Electron : Kind::Photon;
+                    resolution = std::hypot(config.ecalA / std::sqrt(energy), config.ecalC);
+                }
+            } else if (chargeTimes3(id) != 0 && absEta < config.trackEta) {
+                if (pt[i] > config.trackPtMin) {
+                    k = Kind::Track;
+                    resolution = std::hypot(config.trackA, config.trackB * pt[i]);
+                }
+            } else if (absEta < config.hcalEta && energy > config.hcalEMin) {
+                k = Kind::Hcal;
+                resolution = std::hypot(config.hcalA / std::sqrt(energy), config.hcalC);
+            }
+            if (k == Kind::Dropped) continue;
+            batch.px[kept] = batch.px[i];
+            batch.py[kept] = batch.py[i];
+            batch.pz[kept] = batch.pz[i];
+            batch.e[kept] = batch.e[i];
+            eta[kept] = eta[i];
+            index[kept] = index[i];
+            kind[kept] = k;
+            sigma[kept] = resolution;
+            kept++;
+        }
+
+        // Gaussian draws (Box-Muller in pairs), then one scale factor per four-vector
+        std::mt19937_64 rng(seeds::splitmix64(config.seed ^ seeds::splitmix64(static_cast<uint64_t>(eventKey))));
+        gauss.resize(kept + 1);
+        for (size_t i = 0; i < kept; i += 2) {
+            double u1 = (static_cast<double>(rng() >> 11) + 0.5) * 0x1.0p-53;
+            double u2 = static_cast<double>(rng() >> 11) * 0x1.0p-53;
+            double radius = std::sqrt(-2.0 * std::log(u1));
+            gauss[i] = radius * std::cos(2.0 * kin::kPi * u2);
+            gauss[i + 1] = radius * std::sin(2.0 * kin::kPi * u2);
+        }
+        double* px = batch.px.data();
+        double* py = batch.py.data();
+        double* pz = batch.pz.data();
+        double* e = batch.e.data();
+        const double* s = sigma.data();
+        const double* g = gauss.data();
+        for (size_t i = 0; i < kept; i++) {
+            const double scale = std::max(0.0, 1.0 + s[i] * g[i]);
+            px[i] *= scale;
+            py[i] *= scale;
+            pz[i] *= scale;
+            e[i] *= scale;
+        }
+        nOut += static_cast<long>(config.towerSize > 0 ? fillTowers(kept, particles) : fillParticles(kept, particles));
+    }
+
+private:
+    size_t fillParticles(size_t kept, std::vector<fastjet::PseudoJet>& particles) {
+        for (size_t i = 0; i < kept; i++) {
+            if (batch.e[i] <= 0) continue;
+            particles.emplace_back(batch.px[i], batch.py[i], batch.pz[i], batch.e[i]);
+            particles.back().set_user_index(index[i]);
+        }
+        return particles.size();
+    }
+
+    // Tracks, electrons and muons as they are; photons and HCAL deposits summed per eta-phi
+    // tower into one massless object along the summed momentum. towerSlot is a flat grid over
+    // the calorimeter acceptance, allocated once; only the cells hit by an event are reset.
+    size_t fillTowers(size_t kept, std::vector<fastjet::PseudoJet>& particles) {
+        towerSums.clear();
+        towerOf.assign(kept, -1);
+        for (size_t i = 0; i < kept; i++) {
+            if (batch.e[i] <= 0) continue;
+            if (kind[i] != Kind::Hcal && kind[i] != Kind::Photon) {
+                particles.emplace_back(batch.px[i], batch.py[i], batch.pz[i], batch.e[i]);
+                particles.back().set_user_index(index[i]);
+                continue;
+            }
+            const double phi = std::atan2(batch.py[i], batch.px[i]) + kin::kPi;
+            const int cellEta = std::min(2 * nEtaHalf - 1,
+                                         std::max(0, static_cast<int>(std::floor(eta[i] / config.towerSize)) + nEtaHalf));
+            const int cellPhi = std::min(nPhi - 1, static_cast<int>(phi / (2 * kin::kPi) * nPhi));
+            int& slot = towerSlot[static_cast<size_t>(cellEta) * nPhi + cellPhi];
+            if (slot < 0) {
+                slot = static_cast<int>(towerSums.size());
+                towerSums.push_back(Tower());
+                towerSums.back().cell = &slot - towerSlot.data();
+            }
+            towerOf[i] = slot;
+            Tower& tower = towerSums[towerOf[i]];
+            tower.px += batch.px[i];
+            tower.py += batch.py[i];
+            tower.pz += batch.pz[i];
+            tower.e += batch.e[i];
+            if (batch.e[i] > tower.leadingE) {
+                tower.leading = index[i];
+                tower.leadingE = batch.e[i];
+            }
+        }
+        for (size_t i = 0; i < kept; i++) {
+            if (towerOf[i] >= 0 && index[i] != towerSums[towerOf[i]].leading) {
+                merged.emplace_back(index[i], towerSums[towerOf[i]].leading);
+            }
+        }
+        for (const Tower& tower : towerSums) {
+            towerSlot[tower.cell] = -1;
+            const double p = std::sqrt(tower.px * tower.px + tower.py * tower.py + tower.pz * tower.pz);
+            if (p <= 0) continue;
+            const double scale = tower.e / p;
+            particles.emplace_back(tower.px * scale, tower.py * scale, tower.pz * scale, tower.e);
+            particles.back().set_user_index(tower.leading);
+        }
+        return particles.size();
+    }
+
+    struct Tower {
+        double px = 0, py = 0, pz = 0, e = 0;
+        int leading = -1;
+        double leadingE = 0;
+        ptrdiff_t cell = 0; // Index into towerSlot
+    };
+
+    Config config;
+    kin::MomentumBatch batch;
+    std::vector<int> index, towerOf;
+    std::vector<double> pt, eta, sigma, gauss;
+    std::vector<Kind> kind;
+    int nEtaHalf = 0, nPhi = 0;
+    std::vector<int> towerSlot; // Tower of each eta-phi cell in this event, -1 if none
+    std::vector<Tower> towerSums;
+    std::vector<std::pair<int, int>> merged;
+    long nIn = 0, nOut = 0;
+};
+
+} // namespace detector
+
+#endif
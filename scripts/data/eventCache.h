@@ -0,0 +1,329 @@
+#ifndef EVENT_CACHE_H
+#define EVENT_CACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "eventSnapshot.h"
+
+// Block-compressed on-disk cache of EventSnapshots, so the analysis can be rerun (new cuts,
+// jet radii, output columns) without pythia.next(). Link with -lz.
+//
+// The whole record is kept, so every ancestry walk (findDaughters, traceToFinalState, ghost
+// seeds) behaves as in the original run. Momenta are quantized to float32; analysis outputs from
+// a replay therefore agree with the direct run to float precision, not bit for bit.
+//
+// File (little endian):
+//   char[8]  magic "HSASEVC1"
+//   uint32   version (4; 3 had no source, 2 no hardProcessSize column either, 1 no eventIndex)
+//   uint32   sourceBytes
+//   char     source[sourceBytes]   input the events were showered from (e.g. the LHE file), or empty
+//   blocks until end of file, each:
+//     uint32 nEvents, uint32 rawBytes, uint32 compressedBytes, uint32 crc32 of the raw bytes
+//     compressedBytes of zlib-deflated raw data
+// Raw block data is columnar, each column byte-shuffled (byte 0 of every value, then byte 1, ...)
+// so the slowly varying high bytes compress well:
+//   int32 processCode[nEvents], eventIndex[nEvents], hardProcessSize[nEvents], nEntries[nEvents], then over
+//   all N entries of the block:
+//   int32 id[N], int16 status[N], int32 mother1[N], mother2[N], daughter1[N], daughter2[N],
+//   float px[N], py[N], pz[N], e[N]
+// Mothers are stored as k - mother and daughters as daughter - k (0 stays 0 for "none"), which
+// turns record indices into small repeating numbers.
+namespace evcache {
+
+const uint32_t kVersion = 4;
+const uint32_t kOldestVersion = 3; // Read as having an empty source
+const size_t kHeaderBytes = 16;
+const size_t kBlockHeaderBytes = 16;
+
+// Column of n values of `width` bytes, transposed so byte b of value i lands at b * n + i
+inline void shuffleBytes(const unsigned char* src, size_t n, size_t width, unsigned char* dst) {
+    for (size_t i = 0; i < n; i++) {
+        for (size_t b = 0; b < width; b++) dst[b * n + i] = src[i * width + b];
+    }
+}
+
+inline void unshuffleBytes(const unsigned char* src, size_t n, size_t width, unsigned char* dst) {
+    for (size_t b = 0; b < width; b++) {
+        for (size_t i = 0; i < n; i++) dst[i * width + b] = src[b * n + i];
+    }
+}
+
+inline int32_t encodeMother(int mother, int k) { return mother > 0 ? k - mother : 0; }
+inline int decodeMother(int32_t delta, int k) { return delta != 0 ? k - delta : 0; }
+inline int32_t encodeDaughter(int daughter, int k) { return daughter > 0 ? daughter - k : 0; }
+inline int decodeDaughter(int32_t delta, int k) { return delta != 0 ? k + delta : 0; }
+
+// Columns of one block, shared by writer and reader
+struct Block {
+    std::vector<int32_t> processCode, eventIndex, hardProcessSize, nEntries;
+    std::vector<int32_t> id, mother1, mother2, daughter1, daughter2;
+    std::vector<int16_t> status;
+    std::vector<float> px, py, pz, e;
+
+    size_t nEvents() const { return processCode.size(); }
+    size_t nTotal() const { return id.size(); }
+
+    void clear() {
+        processCode.clear(); eventIndex.clear(); hardProcessSize.clear(); nEntries.clear();
+        id.clear(); mother1.clear(); mother2.clear(); daughter1.clear(); daughter2.clear();
+        status.clear();
+        px.clear(); py.clear(); pz.clear(); e.clear();
+    }
+
+    size_t rawBytes() const {
+        return 4 * (4 * nEvents()) + nTotal() * (4 + 2 + 4 * 4 + 4 * 4);
+    }
+
+    template <class F>
+    void forEachColumn(F f) {
+        f(processCode, nEvents()); f(eventIndex, nEvents()); f(hardProcessSize, nEvents()); f(nEntries, nEvents());
+        f(id, nTotal()); f(status, nTotal());
+        f(mother1, nTotal()); f(mother2, nTotal()); f(daughter1, nTotal()); f(daughter2, nTotal());
+        f(px, nTotal()); f(py, nTotal()); f(pz, nTotal()); f(e, nTotal());
+    }
+};
+
+class Writer {
+public:
+    // Blocks hold up to this many events; big enough to compress well, small enough to stream
+    static const size_t kBlockEvents = 64;
+
+    ~Writer() { close(); }
+
+    // source: what the events come from, read back by Reader::source() (e.g. for LHE metadata)
+    bool open(const std::string& path, const std::string& source = std::string(), int levelIn = 1) {
+        level = levelIn;
+        name = path;
+        failed = false;
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            std::cerr << "Error: Could not open event cache for writing: " << path << std::endl;
+            return false;
+        }
+        const uint32_t header[2] = {kVersion, static_cast<uint32_t>(source.size())};
+        nWritten = 0;
+        if (std::fwrite("HSASEVC1", 1, 8, file) != 8 || std::fwrite(header, 4, 2, file) != 2 ||
+            std::fwrite(source.data(), 1, source.size(), file) != source.size()) {
+            fail("could not write the header");
+            return false;
+        }
+        return true;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+    long events() const { return nWritten; }
+
+    // False once a block could not be compressed or written (e.g. disk full); the cache is then
+    // incomplete and the run should fail
+    bool write(const EventSnapshot& snap) {
+        if (failed) return false;
+        const int n = snap.size();
+        block.processCode.push_back(snap.processCode);
+        block.eventIndex.push_back(static_cast<int32_t>(snap.eventIndex));
+        block.hardProcessSize.push_back(snap.hardProcessSize);
+        block.nEntries.push_back(n);
+        for (int k = 0; k < n; k++) {
+            block.id.push_back(snap.id[k]);
+            block.status.push_back(static_cast<int16_t>(snap.status[k]));
+            block.mother1.push_back(encodeMother(snap.mother1[k], k));
+            block.mother2.push_back(encodeMother(snap.mother2[k], k));
+            block.daughter1.push_back(encodeDaughter(snap.daughter1[k], k));
+            block.daughter2.push_back(encodeDaughter(snap.daughter2[k], k));
+            block.px.push_back(static_cast<float>(snap.px[k]));
+            block.py.push_back(static_cast<float>(snap.py[k]));
+            block.pz.push_back(static_cast<float>(snap.pz[k]));
+            block.e.push_back(static_cast<float>(snap.e[k]));
+        }
+        nWritten++;
+        return block.nEvents() < kBlockEvents || flush();
+    }
+
+    // Writes the last block; false if any part of the cache failed to reach the file
+    bool close() {
+        if (!file) return !failed;
+        flush();
+        if (std::fclose(file) != 0 && !failed) {
+            std::cerr << "Error: Could not close event cache " << name << std::endl;
+            failed = true;
+        }
+        file = nullptr;
+        return !failed;
+    }
+
+private:
+    void fail(const char* what) {
+        if (!failed) std::cerr << "Error: Event cache " << name << ": " << what << std::endl;
+        failed = true;
+    }
+
+    bool flush() {
+        if (failed) return false;
+        if (block.nEvents() == 0) return true;
+        raw.resize(block.rawBytes());
+        unsigned char* out = raw.data();
+        block.forEachColumn([&](auto& column, size_t n) {
+            const size_t width = sizeof(column[0]);
+            shuffleBytes(reinterpret_cast<const unsigned char*>(column.data()), n, width, out);
+            out += n * width;
+        });
+
+        uLongf compressedBytes = compressBound(static_cast<uLong>(raw.size()));
+        compressed.resize(compressedBytes);
+        if (compress2(compressed.data(), &compressedBytes, raw.data(), static_cast<uLong>(raw.size()), level) != Z_OK) {
+            fail("block compression failed");
+            return false;
+        }
+
+        const uint32_t header[4] = {static_cast<uint32_t>(block.nEvents()), static_cast<uint32_t>(raw.size()),
+                                    static_cast<uint32_t>(compressedBytes),
+                                    static_cast<uint32_t>(crc32(0L, raw.data(), static_cast<uInt>(raw.size())))};
+        if (std::fwrite(header, 4, 4, file) != 4 ||
+            std::fwrite(compressed.data(), 1, compressedBytes, file) != compressedBytes) {
+            fail("write failed (disk full?)");
+            return false;
+        }
+        block.clear();
+        return true;
+    }
+
+    std::string name;
+    bool failed = false;
+    FILE* file = nullptr;
+    int level = 1;
+    long nWritten = 0;
+    Block block;
+    std::vector<unsigned char> raw, compressed;
+};
+
+class Reader {
+public:
+    ~Reader() { close(); }
+
+    bool open(const std::string& path) {
+        file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            std::cerr << "Error: Could not open event cache: " << path << std::endl;
+            return false;
+        }
+        char magic[8];
+        uint32_t header[2];
+        if (std::fread(magic, 1, 8, file) != 8 || std::memcmp(magic, "HSASEVC1", 8) != 0 ||
+            std::fread(header, 4, 2, file) != 2 || header[0] < kOldestVersion || header[0] > kVersion) {
+            std::cerr << "Error: Not an event cache (or unsupported version): " << path << std::endl;
+            close();
+            return false;
+        }
+        sourceName.assign(header[0] >= 4 ? header[1] : 0, '\0');
+        if (std::fread(&sourceName[0], 1, sourceName.size(), file) != sourceName.size()) {
+            std::cerr << "Error: Truncated event cache header: " << path << std::endl;
+            close();
+            return false;
+        }
+        name = path;
+        return true;
+    }
+
+    // Input the cached events were showered from, as given to Writer::open(); empty if unknown
+    const std::string& source() const { return sourceName; }
+
+    void close() {
+        if (file) std::fclose(file);
+        file = nullptr;
+    }
+
+    // Next cached event into snap; false at the end of the cache or on a corrupt block
+    bool next(EventSnapshot& snap) {
+        if (eventInBlock == block.nEvents() && !readBlock()) return false;
+        const int n = block.nEntries[eventInBlock];
+        const size_t k0 = entryInBlock;
+
+        snap.clear();
+        snap.px.reserve(n); snap.py.reserve(n); snap.pz.reserve(n); snap.e.reserve(n);
+        snap.id.reserve(n); snap.status.reserve(n);
+        snap.mother1.reserve(n); snap.mother2.reserve(n); snap.daughter1.reserve(n); snap.daughter2.reserve(n);
+        for (int k = 0; k < n; k++) {
+            const size_t c = k0 + k;
+            snap.px.push_back(block.px[c]);
+            snap.py.push_back(block.py[c]);
+            snap.pz.push_back(block.pz[c]);
+            snap.e.push_back(block.e[c]);
+            snap.id.push_back(block.id[c]);
+            snap.status.push_back(block.status[c]);
+            snap.mother1.push_back(decodeMother(block.mother1[c], k));
+            snap.mother2.push_back(decodeMother(block.mother2[c], k));
+            snap.daughter1.push_back(decodeDaughter(block.daughter1[c], k));
+            snap.daughter2.push_back(decodeDaughter(block.daughter2[c], k));
+            if (block.status[c] > 0) snap.finalState.push_back(k);
+        }
+        snap.processCode = block.processCode[eventInBlock];
+        snap.eventIndex = block.eventIndex[eventInBlock];
+        snap.hardProcessSize = block.hardProcessSize[eventInBlock];
+
+        eventInBlock++;
+        entryInBlock += n;
+        return true;
+    }
+
+private:
+    bool readBlock() {
+        uint32_t header[4];
+        if (!file || std::fread(header, 4, 4, file) != 4) return false;
+        compressed.resize(header[2]);
+        raw.resize(header[1]);
+        uLongf rawBytes = header[1];
+        if (std::fread(compressed.data(), 1, header[2], file) != header[2] ||
+            uncompress(raw.data(), &rawBytes, compressed.data(), header[2]) != Z_OK || rawBytes != header[1] ||
+            crc32(0L, raw.data(), static_cast<uInt>(raw.size())) != header[3]) {
+            std::cerr << "Error: Corrupt block in event cache " << name << std::endl;
+            return false;
+        }
+
+        // Entry counts first, since their sum sizes the entry columns
+        block.processCode.resize(header[0]);
+        block.eventIndex.resize(header[0]);
+        block.hardProcessSize.resize(header[0]);
+        block.nEntries.resize(header[0]);
+        if (raw.size() < 16 * size_t(header[0])) {
+            std::cerr << "Error: Inconsistent block in event cache " << name << std::endl;
+            return false;
+        }
+        const unsigned char* in = raw.data() + 12 * size_t(header[0]);
+        unshuffleBytes(in, header[0], 4, reinterpret_cast<unsigned char*>(block.nEntries.data()));
+        size_t nTotal = 0;
+        for (int32_t n : block.nEntries) nTotal += n;
+
+        block.id.resize(nTotal); block.status.resize(nTotal);
+        block.mother1.resize(nTotal); block.mother2.resize(nTotal);
+        block.daughter1.resize(nTotal); block.daughter2.resize(nTotal);
+        block.px.resize(nTotal); block.py.resize(nTotal); block.pz.resize(nTotal); block.e.resize(nTotal);
+        if (block.rawBytes() != raw.size()) {
+            std::cerr << "Error: Inconsistent block in event cache " << name << std::endl;
+            return false;
+        }
+        in = raw.data();
+        block.forEachColumn([&](auto& column, size_t n) {
+            const size_t width = sizeof(column[0]);
+            unshuffleBytes(in, n, width, reinterpret_cast<unsigned char*>(column.data()));
+            in += n * width;
+        });
+
+        eventInBlock = 0;
+        entryInBlock = 0;
+        return header[0] > 0 || readBlock();
+    }
+
+    FILE* file = nullptr;
+    std::string name, sourceName;
+    Block block;
+    size_t eventInBlock = 0, entryInBlock = 0;
+    std::vector<unsigned char> raw, compressed;
+};
+
+}
+
+#endif
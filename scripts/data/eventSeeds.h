@@ -0,0 +1,83 @@
+#ifndef EVENT_SEEDS_H
+#define EVENT_SEEDS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Counter-based seeding: event i of a run is generated from Pythia's random stream reseeded
+// with eventSeed(runSeed, i), so any event can be regenerated on its own from (runSeed, i)
+// without replaying the i events before it. Pythia.init() is seeded from (runSeed, kInitCounter).
+// This holds as long as nothing carried between events changes the generation, i.e. no
+// phase-space maximum is raised mid-run (Pythia warns when that happens).
+namespace seeds {
+
+// Counter reserved for the Pythia initialization
+const uint64_t kInitCounter = ~uint64_t(0);
+
+inline uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Seed for Pythia's Rndm::init / Random:seed, which accepts 1..900000000
+inline int eventSeed(uint64_t runSeed, uint64_t counter) {
+    return 1 + static_cast<int>(splitmix64(runSeed ^ splitmix64(counter)) % 900000000ULL);
+}
+
+// Stable seed from a name, e.g. an input file (FNV-1a, then mixed)
+inline uint64_t nameSeed(const std::string& name) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : name) hash = (hash ^ c) * 0x100000001b3ULL;
+    return splitmix64(hash);
+}
+
+// Fresh run seed when none is given; printed by the generators so the run can be reproduced
+inline uint64_t randomRunSeed() {
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) ^ device();
+}
+
+// Upper bound on the events of an --event list, which is expanded one entry per event; whole
+// runs go through --nevents instead
+const long kMaxListedEvents = 10000000;
+
+// "17999", "3,17,42" or ranges "100-199" (inclusive), in any combination; sorted and unique
+inline bool parseEventList(const std::string& text, std::vector<long>& events) {
+    events.clear();
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        std::string item = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        char* end = nullptr;
+        long first = std::strtol(item.c_str(), &end, 10);
+        long last = first;
+        if (end == item.c_str() || first < 0) return false;
+        if (*end == '-') {
+            const char* rest = end + 1;
+            last = std::strtol(rest, &end, 10);
+            if (end == rest || last < first) return false;
+        }
+        if (*end != '\0') return false;
+        if (last - first >= kMaxListedEvents - static_cast<long>(events.size())) {
+            std::cerr << "Error: Event list '" << text << "' holds more than " << kMaxListedEvents << " events" << std::endl;
+            return false;
+        }
+        for (long i = first; i <= last; i++) events.push_back(i);
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    std::sort(events.begin(), events.end());
+    events.erase(std::unique(events.begin(), events.end()), events.end());
+    return !events.empty();
+}
+
+}
+
+#endif
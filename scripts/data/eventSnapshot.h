@@ -0,0 +1,113 @@
+#ifndef EVENT_SNAPSHOT_H
+#define EVENT_SNAPSHOT_H
+
+#include <vector>
+#include "Pythia8/Pythia.h"
+#include "fastjet/ClusterSequence.hh"
+
+// Structure-of-arrays copy of the few Particle fields the analysis reads.
+// Filled once per event straight after pythia.next(); every later step (Higgs search,
+// decay lookup, final-state selection, PseudoJet construction) reads these contiguous
+// arrays instead of the ~200-byte Particle objects. The vectors are cleared, never
+// shrunk, so a snapshot reused across events stops allocating once it has seen the
+// largest event.
+struct EventSnapshot {
+    std::vector<double> px, py, pz, e;
+    std::vector<int> id, status;
+    std::vector<int> mother1, mother2, daughter1, daughter2;
+    std::vector<int> finalState; // Event indices of final-state particles, in record order
+    int processCode = 0;
+    int hardProcessSize = 0; // Entries of pythia.process, which lead the event record; 0 if unknown
+    long eventIndex = -1; // Generator event counter the event was seeded from, -1 if unknown
+
+    int size() const { return static_cast<int>(id.size()); }
+    bool isFinal(int k) const { return status[k] > 0; }
+    Pythia8::Vec4 p(int k) const { return Pythia8::Vec4(px[k], py[k], pz[k], e[k]); }
+
+    void clear() {
+        px.clear(); py.clear(); pz.clear(); e.clear();
+        id.clear(); status.clear();
+        mother1.clear(); mother2.clear(); daughter1.clear(); daughter2.clear();
+        finalState.clear();
+        processCode = 0;
+        hardProcessSize = 0;
+        eventIndex = -1;
+    }
+
+    void fill(const Pythia8::Event& event, int code, int hardSize = 0) {
+        clear();
+        const int n = event.size();
+        px.reserve(n); py.reserve(n); pz.reserve(n); e.reserve(n);
+        id.reserve(n); status.reserve(n);
+        mother1.reserve(n); mother2.reserve(n); daughter1.reserve(n); daughter2.reserve(n);
+        for (int k = 0; k < n; k++) {
+            const Pythia8::Particle& particle = event[k];
+            px.push_back(particle.px());
+            py.push_back(particle.py());
+            pz.push_back(particle.pz());
+            e.push_back(particle.e());
+            id.push_back(particle.id());
+            status.push_back(particle.status());
+            mother1.push_back(particle.mother1());
+            mother2.push_back(particle.mother2());
+            daughter1.push_back(particle.daughter1());
+            daughter2.push_back(particle.daughter2());
+            if (particle.isFinal()) finalState.push_back(k);
+        }
+        processCode = code;
+        hardProcessSize = hardSize;
+    }
+};
+
+// Indices of all entries whose mother1 or mother2 is the given entry
+inline void findDaughters(const EventSnapshot& snap, int index, std::vector<int>& daughters) {
+    daughters.clear();
+    const int n = snap.size();
+    for (int k = 0; k < n; k++) {
+        if (snap.mother1[k] == index || snap.mother2[k] == index) {
+            daughters.push_back(k);
+        }
+    }
+}
+
+// Call f(d) for each daughter of the entry, following Pythia's daughter1/daughter2 conventions
+// (range, single daughter, or two separate daughters when daughter2 < daughter1)
+template <class F>
+inline void forEachDaughter(const EventSnapshot& snap, int index, F f) {
+    int d1 = snap.daughter1[index], d2 = snap.daughter2[index];
+    if (d1 <= 0) return;
+    if (d2 == 0 || d2 == d1) {
+        f(d1);
+    } else if (d2 > d1) {
+        for (int d = d1; d <= d2; d++) f(d);
+    } else {
+        f(d1);
+        f(d2);
+    }
+}
+
+// Recursive function to trace a particle to its final state descendants
+inline void traceToFinalState(const EventSnapshot& snap, int index, std::vector<int>& finalStateParticles) {
+    if (snap.isFinal(index)) {
+        finalStateParticles.push_back(index);
+        return;
+    }
+    for (int d = snap.daughter1[index]; d <= snap.daughter2[index]; ++d) {
+        if (d > 0 && d < snap.size()) {
+            traceToFinalState(snap, d, finalStateParticles);
+        }
+    }
+}
+
+// Final-state particles as FastJet input, user_index set to the event index
+inline void fillPseudoJets(const EventSnapshot& snap, std::vector<fastjet::PseudoJet>& particles) {
+    particles.clear();
+    particles.reserve(snap.finalState.size());
+    for (int k : snap.finalState) {
+        fastjet::PseudoJet particle(snap.px[k], snap.py[k], snap.pz[k], snap.e[k]);
+        particle.set_user_index(k);
+        particles.push_back(particle);
+    }
+}
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef FEATURE_MATRIX_H
+#define FEATURE_MATRIX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Row-major float32 feature matrix written as a NumPy .npy (format 1.0) file, so a run loads
+// with a single np.load(path, mmap_mode="r"). The row count is unknown until the run ends,
+// so the header is written with a fixed width and rewritten with the final shape on close().
+class NpyMatrixWriter {
+public:
+    // Magic, version, header length and the padded header dict; a multiple of 64 as numpy expects
+    static constexpr size_t kHeaderBytes = 128;
+
+    ~NpyMatrixWriter() { close(); }
+
+    bool open(const std::string& pathIn, uint32_t nColumnsIn) {
+        path = pathIn;
+        nColumns = nColumnsIn;
+        nRows = 0;
+        out.open(path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "Error: Could not open feature matrix for writing: " << path << std::endl;
+            return false;
+        }
+        writeHeader();
+        return true;
+    }
+
+    bool isOpen() const { return out.is_open(); }
+    uint64_t rows() const { return nRows; }
+
+    void push(const float* row) {
+        out.write(reinterpret_cast<const char*>(row), nColumns * sizeof(float));
+        nRows++;
+    }
+
+    void close() {
+        if (!out.is_open()) return;
+        out.seekp(0);
+        writeHeader();
+        out.close();
+    }
+
+private:
+    void writeHeader() {
+        std::ostringstream dict;
+        dict << "{'descr': '<f4', 'fortran_order': False, 'shape': (" << nRows << ", " << nColumns << "), }";
+        std::string header = dict.str();
+        header.resize(kHeaderBytes - 10 - 1, ' ');
+        header += '\n';
+
+        const uint16_t headerLength = static_cast<uint16_t>(header.size());
+        out.write("\x93NUMPY\x01\x00", 8);
+        out.write(reinterpret_cast<const char*>(&headerLength), 2); // Little endian
+        out.write(header.data(), header.size());
+    }
+
+    std::string path;
+    std::ofstream out;
+    uint32_t nColumns = 0;
+    uint64_t nRows = 0;
+};
+
+// Wilson coefficients from the JSON written by coefficientUpdate.py ({"1": c1, ..., "9": c9}),
+// ordered by index. Returns false if the file is missing or holds no coefficients.
+inline bool readCoefficientsJson(const std::string& path, std::vector<double>& coefficients) {
+    coefficients.clear();
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "Error: Could not open coefficient file: " << path << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string text = buffer.str();
+
+    std::vector<std::pair<int, double>> entries;
+    size_t pos = 0;
+    while ((pos = text.find('"', pos)) != std::string::npos) {
+        size_t keyEnd = text.find('"', pos + 1);
+        size_t colon = text.find(':', keyEnd);
+        if (keyEnd == std::string::npos || colon == std::string::npos) break;
+        int index = std::atoi(text.c_str() + pos + 1);
+        char* end = nullptr;
+        double value = std::strtod(text.c_str() + colon + 1, &end);
+        if (end == text.c_str() + colon + 1) break;
+        entries.emplace_back(index, value);
+        pos = end - text.c_str();
+    }
+    std::sort(entries.begin(), entries.end());
+    for (const auto& entry : entries) coefficients.push_back(entry.second);
+
+    if (coefficients.empty()) {
+        std::cerr << "Error: No coefficients found in " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Coefficients randomized by coefficientUpdate.py: entries 1..9 of the param_card's BLOCK SMEFT
+const int kSmeftCoefficients = 9;
+
+// Wilson coefficients from the BLOCK SMEFT of the param_card MadGraph embeds in the LHE header
+// (<slha>), ordered by index. Returns false, without an error, if the file is not an LHE file or
+// its header has no such block.
+inline bool readLheSmeftBlock(const std::string& lhePath, std::vector<double>& coefficients) {
+    coefficients.clear();
+    std::ifstream in(lhePath);
+    std::string line;
+    if (!std::getline(in, line) || line.find("<LesHouchesEvents") == std::string::npos) return false;
+
+    std::vector<std::pair<int, double>> entries;
+    bool inBlock = false;
+    while (std::getline(in, line) && line.find("<init") == std::string::npos) {
+        std::istringstream fields(line);
+        std::string first, second;
+        fields >> first;
+        std::transform(first.begin(), first.end(), first.begin(), ::toupper);
+        if (first == "BLOCK" || first == "DECAY") {
+            fields >> second;
+            std::transform(second.begin(), second.end(), second.begin(), ::toupper);
+            inBlock = (first == "BLOCK" && second == "SMEFT");
+            continue;
+        }
+        if (!inBlock || first.empty() || first[0] == '#') continue;
+        char* end = nullptr;
+        long index = std::strtol(first.c_str(), &end, 10);
+        double value;
+        if (*end == '\0' && index >= 1 && index <= kSmeftCoefficients && (fields >> value)) {
+            entries.emplace_back(static_cast<int>(index), value);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    for (const auto& entry : entries) coefficients.push_back(entry.second);
+    return !coefficients.empty();
+}
+
+// JSON string literal of text: quotes, backslashes and control characters escaped
+inline std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+        } else {
+            quoted += static_cast<char>(c);
+        }
+    }
+    return quoted + "\"";
+}
+
+// First line of the CSV output: the run metadata as JSON behind a '#', so readers skip it as
+// before (skiprows=1) or parse it with json.loads(line[len("# Run metadata: "):])
+inline void writeRunMetadataLine(std::ostream& out, const std::string& lheFile, const std::string& coefficientSource,
+                                 const std::vector<double>& coefficients) {
+    std::streamsize precision = out.precision(17);
+    out << "# Run metadata: {\"lhe_file\": " << jsonString(lheFile) << ", \"coefficient_source\": "
+        << jsonString(coefficientSource) << ", \"wilson_coefficients\": [";
+    for (size_t c = 0; c < coefficients.size(); c++) {
+        out << (c ? ", " : "") << coefficients[c];
+    }
+    out << "]}\n";
+    out.precision(precision);
+}
+
+// Run-level metadata stored once next to the feature matrix, as <matrix>.meta.json
+inline bool writeMatrixMetadata(const std::string& matrixPath, const std::vector<std::string>& featureNames,
+                                uint64_t nRows, const std::string& lheFile, const std::string& coefficientSource,
+                                const std::vector<double>& coefficients) {
+    std::ofstream meta(matrixPath + ".meta.json");
+    if (!meta.is_open()) {
+        std::cerr << "Error: Could not write metadata for " << matrixPath << std::endl;
+        return false;
+    }
+    meta.precision(17);
+    meta << "{\n  \"dtype\": \"float32\",\n  \"rows\": " << nRows << ",\n  \"features\": [";
+    for (size_t f = 0; f < featureNames.size(); f++) {
+        meta << (f ? ", " : "") << jsonString(featureNames[f]);
+    }
+    meta << "],\n  \"lhe_file\": " << jsonString(lheFile) << ",\n  \"coefficient_source\": "
+         << jsonString(coefficientSource) << ",\n  \"wilson_coefficients\": [";
+    for (size_t c = 0; c < coefficients.size(); c++) {
+        meta << (c ? ", " : "") << coefficients[c];
+    }
+    meta << "]\n}\n";
+    return true;
+}
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef FEATURE_RING_H
+#define FEATURE_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Single-producer/single-consumer ring of float32 feature batches in POSIX shared memory,
+// written by training_smeft100.cc and read by scripts/model/featureRing.py while the shower
+// is still running.
+//
+// Layout (little endian, all offsets in bytes; mirrored in featureRing.py):
+//   0    char[8]   magic "HSASRING"
+//   8    uint32    version (1)
+//   12   uint32    nFeatures        floats per row
+//   16   uint32    rowsPerSlot      rows per batch
+//   20   uint32    nSlots           batches in the ring
+//   24   uint64    slotBytes        stride between slots
+//   32   uint64    dataOffset       offset of slot 0
+//   40   uint32    nLabels          run-level labels (e.g. Wilson coefficients), 0 if unknown
+//   44   uint32    reserved
+//   64   uint64    head             batches published; written only by the producer
+//   128  uint64    tail             batches consumed; written only by the consumer
+//   192  uint32    done             1 once the producer has published its last batch
+//   256  float64   labels[32]
+//   dataOffset + s * slotBytes:
+//        uint32    nRows            rows used in this batch (<= rowsPerSlot)
+//        uint32    reserved
+//        float32   rows[rowsPerSlot][nFeatures]
+//
+// Protocol: the producer fills slot head % nSlots only while head - tail < nSlots, then
+// publishes it with a release store of head + 1. The consumer reads head with acquire
+// semantics, uses slot tail % nSlots in place, and frees it with a store of tail + 1.
+// head/tail sit on their own cache lines and each has a single writer, so no locks are
+// needed. The consumer unlinks the segment once done is set and the ring is drained.
+// The run-level labels are part of the header: written by open() before the magic and never
+// changed afterwards, since a reader reads them once when it attaches.
+// A producer that finds the ring full waits for the consumer, but gives up once no batch has
+// been consumed for kStallTimeout (the consumer never attached or has died): push() then
+// fails, and keeps failing, so the run can stop with an error instead of hanging.
+class FeatureRingWriter {
+public:
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kMaxLabels = 32;
+    static constexpr uint64_t kDataOffset = 512;
+    static constexpr std::chrono::seconds kStallTimeout{600}; // As the reader's attach timeout
+
+    ~FeatureRingWriter() { close(); }
+
+    // labels: run-level labels shared by every row (e.g. Wilson coefficients), at most kMaxLabels
+    bool open(const std::string& nameIn, uint32_t nFeaturesIn, const std::vector<double>& labels,
+              uint32_t rowsPerSlotIn = 4096, uint32_t nSlotsIn = 64) {
+        name = (nameIn.empty() || nameIn[0] != '/') ? "/" + nameIn : nameIn;
+        nFeatures = nFeaturesIn;
+        rowsPerSlot = rowsPerSlotIn;
+        nSlots = nSlotsIn;
+        stalled = false;
+        slotBytes = (8 + uint64_t(rowsPerSlot) * nFeatures * sizeof(float) + 63) / 64 * 64;
+        size = kDataOffset + slotBytes * nSlots;
+
+        int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+        if (fd < 0) {
+            std::cerr << "Error: Could not create shared memory segment " << name << std::endl;
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            std::cerr << "Error: Could not size shared memory segment " << name << std::endl;
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Error: Could not map shared memory segment " << name << std::endl;
+            return false;
+        }
+        base = static_cast<char*>(mapped);
+
+        // Header fields first, magic last, so a reader never sees a half-written header
+        std::memcpy(base + 8, &kVersion, 4);
+        std::memcpy(base + 12, &nFeatures, 4);
+        std::memcpy(base + 16, &rowsPerSlot, 4);
+        std::memcpy(base + 20, &nSlots, 4);
+        std::memcpy(base + 24, &slotBytes, 8);
+        std::memcpy(base + 32, &kDataOffset, 8);
+        uint32_t nLabels = static_cast<uint32_t>(std::min<size_t>(labels.size(), kMaxLabels));
+        std::memcpy(base + 40, &nLabels, 4);
+        if (nLabels > 0) std::memcpy(base + 256, labels.data(), nLabels * sizeof(double));
+        head().store(0, std::memory_order_relaxed);
+        tail().store(0, std::memory_order_relaxed);
+        done().store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(base, "HSASRING", 8);
+        return true;
+    }
+
+    bool isOpen() const { return base != nullptr; }
+
+    // Append one row of nFeatures floats, publishing the batch once it is full; false if the
+    // consumer stalled (see kStallTimeout)
+    bool push(const float* row) {
+        if (!slot && !acquireSlot()) return false;
+        std::memcpy(slot + 8 + uint64_t(rowsInSlot) * nFeatures * sizeof(float), row, nFeatures * sizeof(float));
+        if (++rowsInSlot == rowsPerSlot) publish();
+        return true;
+    }
+
+    // Publish a partially filled batch
+    void flush() {
+        if (slot && rowsInSlot > 0) publish();
+    }
+
+    void close() {
+        if (!base) return;
+        flush();
+        done().store(1, std::memory_order_release);
+        munmap(base, size);
+        base = nullptr;
+    }
+
+private:
+    std::atomic<uint64_t>& head() { return *reinterpret_cast<std::atomic<uint64_t>*>(base + 64); }
+    std::atomic<uint64_t>& tail() { return *reinterpret_cast<std::atomic<uint64_t>*>(base + 128); }
+    std::atomic<uint32_t>& done() { return *reinterpret_cast<std::atomic<uint32_t>*>(base + 192); }
+
+    // Wait for a free slot; the consumer may be busy training, but must free a slot within
+    // kStallTimeout of the last one
+    bool acquireSlot() {
+        if (stalled) return false;
+        uint64_t h = head().load(std::memory_order_relaxed);
+        uint64_t t = tail().load(std::memory_order_acquire);
+        auto deadline = std::chrono::steady_clock::now() + kStallTimeout;
+        while (h - t >= nSlots) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            uint64_t consumed = tail().load(std::memory_order_acquire);
+            if (consumed != t) {
+                t = consumed;
+                deadline = std::chrono::steady_clock::now() + kStallTimeout;
+            } else if (std::chrono::steady_clock::now() > deadline) {
+                std::cerr << "Error: Feature ring " << name << " full and no batch consumed for "
+                          << kStallTimeout.count() << " s; is the consumer running?" << std::endl;
+                stalled = true;
+                return false;
+            }
+        }
+        slot = base + kDataOffset + (h % nSlots) * slotBytes;
+        rowsInSlot = 0;
+        return true;
+    }
+
+    void publish() {
+        std::memcpy(slot, &rowsInSlot, 4);
+        head().store(head().load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        slot = nullptr;
+        rowsInSlot = 0;
+    }
+
+    std::string name;
+    char* base = nullptr;
+    char* slot = nullptr;
+    uint32_t nFeatures = 0, rowsPerSlot = 0, nSlots = 0, rowsInSlot = 0;
+    uint64_t slotBytes = 0, size = 0;
+    bool stalled = false;
+};
+
+#endif
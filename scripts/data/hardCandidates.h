@@ -0,0 +1,81 @@
+#ifndef HARD_CANDIDATES_H
+#define HARD_CANDIDATES_H
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "eventSnapshot.h"
+
+// Membership test for a fixed set of PDG ids, as a lookup table built at compile time
+template <int... Ids>
+struct IdSet {
+    static constexpr int kRange = 64;
+    static_assert(((Ids > -kRange && Ids < kRange) && ...), "IdSet covers ids in (-64, 64)");
+
+    static constexpr std::array<bool, 2 * kRange> table = [] {
+        std::array<bool, 2 * kRange> t{};
+        ((t[Ids + kRange] = true), ...);
+        return t;
+    }();
+
+    static bool contains(int id) { return id > -kRange && id < kRange && table[id + kRange]; }
+};
+
+using HiggsIds = IdSet<25>;
+using ScalarIds = IdSet<25, 35, 36, 37, -37>;
+
+// Follow the recoil/copy chain of entry k (a single daughter with the same id) to its last copy
+inline int lastCopy(const EventSnapshot& snap, int k) {
+    for (;;) {
+        const int d1 = snap.daughter1[k], d2 = snap.daughter2[k];
+        if (d1 <= 0 || (d2 != 0 && d2 != d1) || d1 >= snap.size() || snap.id[d1] != snap.id[k]) return k;
+        k = d1;
+    }
+}
+
+// Higgs candidates of an event: last copies at status -62 of particles with an id in Ids.
+// The search starts from the hard-process entries, which lead the event record (the first
+// snap.hardProcessSize entries), follows each copy chain to its last copy, and descends into
+// the decay products of hard-process resonances (status -22 / -23). Only the hard-process tree
+// is visited, so the cost does not grow with the shower multiplicity. Without a hard-process
+// size (e.g. a snapshot not filled from a Pythia event) the whole record is scanned.
+// One instance per worker; the buffers are reused across events.
+template <class Ids>
+class HardCandidates {
+public:
+    const std::vector<int>& find(const EventSnapshot& snap) {
+        candidates.clear();
+        const int nHard = std::min(snap.hardProcessSize, snap.size());
+        if (nHard <= 0) {
+            for (int j = 0; j < snap.size(); j++) {
+                if (Ids::contains(snap.id[j]) && snap.status[j] == -62) candidates.push_back(j);
+            }
+            return candidates;
+        }
+
+        stack.clear();
+        for (int k = 1; k < nHard; k++) {
+            if (isHard(snap.status[k])) stack.push_back(k);
+        }
+        while (!stack.empty()) {
+            const int k = lastCopy(snap, stack.back());
+            stack.pop_back();
+            if (Ids::contains(snap.id[k]) && snap.status[k] == -62) candidates.push_back(k);
+            forEachDaughter(snap, k, [&](int d) {
+                if (d > k && d < snap.size() && isHard(snap.status[d])) stack.push_back(d);
+            });
+        }
+        // Record order, as the full scan gave, and once per candidate if paths meet
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+        return candidates;
+    }
+
+private:
+    // Hard-process intermediate (22) and outgoing (23) status codes
+    static bool isHard(int status) { return status == 22 || status == -22 || status == 23 || status == -23; }
+
+    std::vector<int> candidates, stack;
+};
+
+#endif
@@ -0,0 +1,377 @@
+#ifndef HIGGS_GENERATOR_H
+#define HIGGS_GENERATOR_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Pythia8/Pythia.h"
+#include "higgsJetAnalysis.h"
+#include "eventCache.h"
+#include "eventSeeds.h"
+#include "hardCandidates.h"
+#include "channelQuotas.h"
+#include "pileupOverlay.h"
+
+// Command line and event loop shared by the tevmain and com*wjets generators. Each
+// generator keeps its own Pythia setup and calls runHiggsEvents() after pythia.init(), or
+// replayHiggsEvents() instead of setting up Pythia when --replay is given. Seeding goes through
+// applyRunSeed() before pythia.init(), so every event can be regenerated from (run seed, index).
+
+struct GeneratorOptions {
+    std::string outputFile;
+    std::vector<JetConfig> jetConfigs = {JetConfig()}; // Anti-kt, R = 0.4
+    JetMatching matching = JetMatching::Trace;
+    std::string cacheFile;  // Also write every generated event to this event cache (eventCache.h)
+    std::string replayFile; // Rerun the analysis over this event cache instead of generating
+    uint64_t runSeed = 0;   // Event i is seeded from (runSeed, i); drawn at random unless --seed is given
+    std::vector<long> events; // Only (re)generate these event indices, sorted; empty = all
+    long nEvents = -1;        // Events to generate, -1 = the generator's default
+    std::vector<ChannelQuota> quotas; // Weighted per-channel sub-runs instead of the inclusive run
+    detector::Config detector;        // Detector response before clustering; disabled by default
+    pileup::Config pileup;            // Minimum-bias overlay and jet area subtraction; disabled by default
+};
+
+inline void printGeneratorUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <output_file> [--jets alg:R[:ptmin],...] [--match trace|ghost]"
+              << " [--cache <file> | --replay <file>] [--seed <n>] [--event <i>[,<j>,<a>-<b>...]] [--nevents <n>]"
+              << " [--quota <code>:<n>[,...] | all:<n>] [--detector generic[,<key>=<value>...]]"
+              << " [--pileup <pool>:<mu>[:nosub]]" << std::endl;
+    std::cerr << "  --jets   jet definitions clustered from the same final state, alg = antikt, kt or cambridge"
+              << " (default antikt:0.4)" << std::endl;
+    std::cerr << "  --match  decay-product to jet matching: trace final-state descendants (default) or"
+              << " ghost-associate the decay products / their B, C hadrons and taus" << std::endl;
+    std::cerr << "  --cache  also store the generated event records in a compressed event cache" << std::endl;
+    std::cerr << "  --replay run the analysis over an event cache written with --cache, without Pythia (with the"
+              << " run's --seed, detector smearing and pileup match the original run)" << std::endl;
+    std::cerr << "  --seed   run seed; with the EventIndex column it reproduces any row (default: random, printed)" << std::endl;
+    std::cerr << "  --event  regenerate (or replay) only these event indices" << std::endl;
+    std::cerr << "  --nevents number of events to generate (default: the generator's run size)" << std::endl;
+    std::cerr << "  --quota  n events per HiggsSM process code (901..909, all = every enabled one), each from its"
+              << " own sub-run; rows get a Weight column (pb) restoring the inclusive mixture" << std::endl;
+    std::cerr << "  --detector acceptance, invisible removal and smearing before clustering (detectorResponse.h),"
+              << " e.g. generic or generic,towers=0.1" << std::endl;
+    std::cerr << "  --pileup overlay Poisson(mu) events from a minimum-bias pool written by minBiasPool at the same"
+              << " energy, with area-based jet subtraction unless :nosub (pileupOverlay.h)" << std::endl;
+}
+
+inline bool parseGeneratorOptions(int argc, char* argv[], GeneratorOptions& options) {
+    bool haveSeed = false;
+    for (int a = 1; a < argc; a++) {
+        std::string arg = argv[a];
+        if (arg == "--jets" && a + 1 < argc) {
+            if (!parseJetConfigs(argv[++a], options.jetConfigs)) return false;
+        } else if (arg == "--match" && a + 1 < argc) {
+            std::string mode = argv[++a];
+            if (mode == "trace") {
+                options.matching = JetMatching::Trace;
+            } else if (mode == "ghost") {
+                options.matching = JetMatching::Ghost;
+            } else {
+                std::cerr << "Error: Unknown matching mode '" << mode << "' (use trace or ghost)" << std::endl;
+                return false;
+            }
+        } else if (arg == "--cache" && a + 1 < argc) {
+            options.cacheFile = argv[++a];
+        } else if (arg == "--replay" && a + 1 < argc) {
+            options.replayFile = argv[++a];
+        } else if (arg == "--seed" && a + 1 < argc) {
+            options.runSeed = std::strtoull(argv[++a], nullptr, 10);
+            haveSeed = true;
+        } else if (arg == "--event" && a + 1 < argc) {
+            if (!seeds::parseEventList(argv[++a], options.events)) {
+                std::cerr << "Error: Bad event list '" << argv[a] << "'" << std::endl;
+                return false;
+            }
+        } else if (arg == "--nevents" && a + 1 < argc) {
+            char* end = nullptr;
+            options.nEvents = std::strtol(argv[++a], &end, 10);
+            if (*end != '\0' || options.nEvents < 0) {
+                std::cerr << "Error: Bad event count '" << argv[a] << "'" << std::endl;
+                return false;
+            }
+        } else if (arg == "--quota" && a + 1 < argc) {
+            if (!parseChannelQuotas(argv[++a], options.quotas)) {
+                std::cerr << "Error: Bad quota list '" << argv[a] << "' (use <code>:<n>,... with codes 901..909,"
+                          << " or all:<n>)" << std::endl;
+                return false;
+            }
+        } else if (arg == "--detector" && a + 1 < argc) {
+            if (!detector::parseDetectorConfig(argv[++a], options.detector)) {
+                std::cerr << "Error: Bad detector configuration '" << argv[a] << "'" << std::endl;
+                return false;
+            }
+        } else if (arg == "--pileup" && a + 1 < argc) {
+            if (!pileup::parsePileupConfig(argv[++a], options.pileup)) {
+                std::cerr << "Error: Bad pileup configuration '" << argv[a] << "' (use <pool>:<mu>[:nosub])" << std::endl;
+                return false;
+            }
+            if (!evcache::Reader().open(options.pileup.poolFile)) return false;
+        } else if (arg.rfind("--", 0) != 0 && options.outputFile.empty()) {
+            options.outputFile = arg;
+        } else {
+            printGeneratorUsage(argv[0]);
+            return false;
+        }
+    }
+    if (options.outputFile.empty() || (!options.cacheFile.empty() && !options.replayFile.empty())) {
+        printGeneratorUsage(argv[0]);
+        return false;
+    }
+    if (!options.quotas.empty() && (!options.replayFile.empty() || !options.events.empty() || options.nEvents >= 0)) {
+        std::cerr << "Error: --quota sets the event counts itself and cannot be combined with --replay, --event"
+                  << " or --nevents" << std::endl;
+        return false;
+    }
+    if (!haveSeed) options.runSeed = seeds::randomRunSeed();
+    return true;
+}
+
+// Seed the initialization from the run seed; call before pythia.init()
+inline void applyRunSeed(Pythia8::Pythia& pythia, const GeneratorOptions& options) {
+    pythia.readString("Random:setSeed = on");
+    pythia.readString("Random:seed = " + std::to_string(seeds::eventSeed(options.runSeed, seeds::kInitCounter)));
+    std::cout << "Run seed: " << options.runSeed << std::endl;
+}
+
+// The detector response of a run: smeared from the run seed unless --detector fixes seed=<n>,
+// so tevmain energies and quota sub-runs, each with its own run seed, get their own noise
+inline detector::Config runDetectorConfig(const GeneratorOptions& options) {
+    detector::Config config = options.detector;
+    if (!config.fixedSeed) config.seed = options.runSeed;
+    return config;
+}
+
+// Pileup overlay of a run, drawn from the run seed like the detector response
+inline pileup::Config runPileupConfig(const GeneratorOptions& options) {
+    pileup::Config config = options.pileup;
+    config.seed = options.runSeed;
+    return config;
+}
+
+// Clustering input size with and without the detector response
+inline void printDetectorSummary(const detector::Response& response) {
+    if (!response.enabled() || response.particlesIn() == 0) return;
+    std::cout << "Detector response: " << response.particlesIn() << " final-state particles -> "
+              << response.particlesOut() << " clustering inputs ("
+              << 100.0 * response.particlesOut() / response.particlesIn() << "%)" << std::endl;
+}
+
+// Mean overlaid pileup and the pool it came from
+inline void printPileupSummary(const pileup::Overlay& overlay, const pileup::Pool& pool, const pileup::Config& config) {
+    if (!config.enabled()) return;
+    std::cout << "Pileup: " << overlay.meanOverlaid() << " minimum-bias events per event (mu = " << config.mu
+              << ") from a pool of " << pool.events() << ", jets " << (config.subtract ? "" : "not ")
+              << "area-subtracted" << std::endl;
+}
+
+// Write a row for every Higgs (id 25, status -62) of the event with >= 2 decay products;
+// returns the number of Higgs candidates seen
+inline int analyzeHiggsEvent(const EventSnapshot& snap, HardCandidates<HiggsIds>& higgs, HiggsJetAnalysis& analysis,
+                             std::ostream& out) {
+    const std::vector<int>& candidates = higgs.find(snap);
+    if (!candidates.empty()) analysis.beginEvent(snap);
+    for (int j : candidates) analysis.writeCandidate(snap, j, out);
+    return static_cast<int>(candidates.size());
+}
+
+// Generate events 0..nEvents-1 (options.nEvents if given, or only options.events), each from its
+// own counter-based seed, writing one row per Higgs (id 25, status -62) with >= 2 decay products.
+// Prints the event rate (parsed by compareBuilds.py). Returns false if the pileup pool or the
+// event cache could not be read or written; a cache write failure stops the run.
+inline bool runHiggsEvents(Pythia8::Pythia& pythia, int nEvents, const GeneratorOptions& options, std::ostream& out) {
+    int totalHCount = 0;
+    int nWarmup = 100; // Events before the allocation counter starts
+
+    // Per-event SoA snapshot and per-candidate analysis buffers, reused across events
+    EventSnapshot snap;
+    HiggsJetAnalysis analysis(options.jetConfigs, options.matching, runDetectorConfig(options),
+                              options.pileup.enabled() && options.pileup.subtract);
+    HardCandidates<HiggsIds> higgs;
+    pileup::Pool pileupPool;
+    if (options.pileup.enabled() && !pileupPool.load(options.pileup.poolFile)) return false;
+    pileup::Overlay overlay(pileupPool, runPileupConfig(options));
+    evcache::Writer cache;
+    if (!options.cacheFile.empty() && !cache.open(options.cacheFile)) return false;
+
+    //Outfile headers
+    analysis.writeHeader(out);
+
+    memstats::reportAtExit();
+    if (options.nEvents >= 0) nEvents = static_cast<int>(options.nEvents);
+    const long nRun = options.events.empty() ? nEvents : static_cast<long>(options.events.size());
+    auto start = std::chrono::steady_clock::now();
+    long n = 0;
+    for (; n < nRun; n++) {
+        const long i = options.events.empty() ? n : options.events[n];
+        if (n == nWarmup) alloccount::reset();
+        {
+            memstats::StageScope generation(memstats::Stage::Generation);
+            pythia.rndm.init(seeds::eventSeed(options.runSeed, i));
+            if (!pythia.next()) continue;
+        }
+        alloccount::Scope countAllocs;
+        snap.fill(pythia.event, pythia.info.code(), pythia.process.size());
+        snap.eventIndex = i;
+        if (cache.isOpen()) {
+            memstats::StageScope output(memstats::Stage::Output);
+            if (!cache.write(snap)) break;
+        }
+        overlay.apply(snap, i); // After the cache, which keeps the signal event alone
+        totalHCount += analyzeHiggsEvent(snap, higgs, analysis, out);
+        memstats::sample(i);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Generated " << n << " events (" << totalHCount << " Higgs candidates) in " << seconds << " s, "
+              << (seconds > 0 ? n / seconds : 0.0) << " events/s" << std::endl;
+    alloccount::report(std::cout, std::max(0L, n - nWarmup));
+    printDetectorSummary(analysis.detectorResponse());
+    printPileupSummary(overlay, pileupPool, options.pileup);
+    if (!cache.isOpen()) return true;
+    if (!cache.close()) return false;
+    std::cout << "Event cache: " << cache.events() << " events -> " << options.cacheFile << std::endl;
+    return true;
+}
+
+// Quota mode (channelQuotas.h): one sub-run per requested HiggsSM process, each a Pythia built
+// from the generator's configured but uninitialized `setup` with only that process switched on.
+// Rows of a sub-run go to <outputPath>.<code>.part first, since its cross section, and with it
+// the event weight sigma_c / N_c, is only known once the sub-run is done; the parts are then
+// merged into `out` with the Weight column (pb) appended. Returns the program exit code.
+inline int runQuotaEvents(Pythia8::Pythia& setup, const GeneratorOptions& options, const std::string& outputPath,
+                          std::ostream& out) {
+    std::vector<ChannelQuota> quotas;
+    for (const ChannelQuota& quota : options.quotas) {
+        if (quota.code != 0) {
+            quotas.push_back(quota);
+            continue;
+        }
+        // all:<n> covers the processes the generator itself switches on
+        bool all = setup.settings.flag("HiggsSM:all");
+        for (const HiggsProcess& process : kHiggsProcesses) {
+            if (all || setup.settings.flag(process.setting)) quotas.push_back({process.code, quota.nEvents});
+        }
+    }
+    if (quotas.empty()) {
+        std::cerr << "Error: --quota all, but the generator enables no HiggsSM process" << std::endl;
+        return 1;
+    }
+
+    struct SubRun {
+        int code;
+        long nEvents;
+        double sigmaPb, sigmaErrPb, weight;
+        std::string partFile;
+    };
+    std::vector<SubRun> subRuns;
+    for (const ChannelQuota& quota : quotas) {
+        SubRun run = {quota.code, quota.nEvents, 0.0, 0.0, 0.0, outputPath + "." + std::to_string(quota.code) + ".part"};
+        std::ofstream part(run.partFile);
+        if (!part.is_open()) {
+            std::cerr << "Error: Could not open file for writing: " << run.partFile << std::endl;
+            return 1;
+        }
+
+        // Independent stream per channel; the printed run seed reproduces the sub-run alone
+        GeneratorOptions channelOptions = options;
+        channelOptions.quotas.clear();
+        channelOptions.nEvents = -1;
+        channelOptions.runSeed = seeds::splitmix64(options.runSeed + quota.code);
+        if (!options.cacheFile.empty()) channelOptions.cacheFile = options.cacheFile + "." + std::to_string(quota.code);
+
+        std::cout << "Channel " << quota.code << ": " << quota.nEvents << " events" << std::endl;
+        Pythia8::Pythia pythia(setup.settings, setup.particleData, false);
+        applyRunSeed(pythia, channelOptions);
+        pythia.readString("HiggsSM:all = off");
+        for (const HiggsProcess& process : kHiggsProcesses) {
+            pythia.readString(std::string(process.setting) + (process.code == quota.code ? " = on" : " = off"));
+        }
+        if (!pythia.init()) {
+            std::cerr << "Error: Pythia initialization failed for channel " << quota.code << std::endl;
+            return 1;
+        }
+        if (!runHiggsEvents(pythia, static_cast<int>(quota.nEvents), channelOptions, part)) return 1;
+        part.close();
+
+        // Pythia's cross sections are in mb
+        const long nAccepted = pythia.info.nAccepted();
+        run.sigmaPb = pythia.info.sigmaGen() * 1e9;
+        run.sigmaErrPb = pythia.info.sigmaErr() * 1e9;
+        run.weight = (nAccepted > 0) ? run.sigmaPb / nAccepted : 0.0;
+        subRuns.push_back(run);
+    }
+
+    // Merge the parts, each row with the weight of its sub-run
+    char weight[32];
+    bool haveHeader = false;
+    for (const SubRun& run : subRuns) {
+        std::ifstream part(run.partFile);
+        std::string line;
+        if (!std::getline(part, line)) {
+            std::cerr << "Error: Could not read " << run.partFile << std::endl;
+            return 1;
+        }
+        if (!haveHeader) {
+            out << line << ",Weight\n";
+            haveHeader = true;
+        }
+        std::snprintf(weight, sizeof(weight), ",%.9e\n", run.weight);
+        while (std::getline(part, line)) out << line << weight;
+        part.close();
+        std::remove(run.partFile.c_str());
+    }
+
+    // How far an inclusive run would have had to go for the same quotas
+    double sigmaTotal = 0.0;
+    long nTotal = 0;
+    for (const SubRun& run : subRuns) {
+        sigmaTotal += run.sigmaPb;
+        nTotal += run.nEvents;
+    }
+    double nInclusive = 0.0;
+    std::cout << "Channel  Events  Sigma (pb)  Error (pb)  Weight (pb/event)" << std::endl;
+    for (const SubRun& run : subRuns) {
+        std::cout << run.code << "  " << run.nEvents << "  " << run.sigmaPb << "  " << run.sigmaErrPb << "  "
+                  << run.weight << std::endl;
+        if (run.sigmaPb > 0) nInclusive = std::max(nInclusive, run.nEvents * sigmaTotal / run.sigmaPb);
+    }
+    std::cout << "Quotas reached with " << nTotal << " events; an inclusive run over these channels would need about "
+              << static_cast<long>(nInclusive) << std::endl;
+    return 0;
+}
+
+// Analysis-only rerun over an event cache at disk speed; returns the program exit code
+inline int replayHiggsEvents(const GeneratorOptions& options, std::ostream& out) {
+    memstats::reportAtExit();
+    evcache::Reader cache;
+    if (!cache.open(options.replayFile)) return 1;
+
+    EventSnapshot snap;
+    HiggsJetAnalysis analysis(options.jetConfigs, options.matching, runDetectorConfig(options),
+                              options.pileup.enabled() && options.pileup.subtract);
+    HardCandidates<HiggsIds> higgs;
+    pileup::Pool pileupPool;
+    if (options.pileup.enabled() && !pileupPool.load(options.pileup.poolFile)) return 1;
+    pileup::Overlay overlay(pileupPool, runPileupConfig(options));
+    analysis.writeHeader(out);
+
+    long nEvents = 0;
+    int totalHCount = 0;
+    while (cache.next(snap)) {
+        if (!options.events.empty() &&
+            !std::binary_search(options.events.begin(), options.events.end(), snap.eventIndex)) continue;
+        nEvents++;
+        overlay.apply(snap, snap.eventIndex);
+        totalHCount += analyzeHiggsEvent(snap, higgs, analysis, out);
+    }
+    printDetectorSummary(analysis.detectorResponse());
+    printPileupSummary(overlay, pileupPool, options.pileup);
+    std::cout << "Replayed " << nEvents << " events (" << totalHCount << " Higgs candidates) from "
+              << options.replayFile << std::endl;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,392 @@
+#ifndef HIGGS_JET_ANALYSIS_H
+#define HIGGS_JET_ANALYSIS_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Pythia8/Pythia.h"
+#include "fastjet/ClusterSequence.hh"
+#include "fastjet/ClusterSequenceArea.hh"
+#include "fastjet/tools/GridMedianBackgroundEstimator.hh"
+#include "fastjet/tools/Subtractor.hh"
+#include "eventSnapshot.h"
+#include "kinematicsKernels.h"
+#include "allocCounter.h"
+#include "jetConfig.h"
+#include "taskPool.h"
+#include "outputSchema.h"
+#include "detectorResponse.h"
+
+// How each decay product is matched to a jet
+enum class JetMatching {
+    Trace, // Trace the decay product to its final-state descendants and take the jet of the last one found
+    Ghost  // Cluster zero-energy ghosts of the decay product (or its B/C hadrons / tau) and read the jet off
+};
+
+// Heavy-quark content of a hadron: +1 if it holds quark `flavour` (4 = c, 5 = b), -1 for the
+// antiquark, 2 for quarkonia, 0 for none. Diquarks and partons give 0.
+inline int heavyQuarkContent(int id, int flavour) {
+    int a = std::abs(id) % 10000;
+    int q1 = (a / 1000) % 10, q2 = (a / 100) % 10, q3 = (a / 10) % 10;
+    if (a < 100 || q3 == 0) return 0;
+    int sign = (id > 0) ? 1 : -1;
+    if (q1 == 0) {
+        // Meson q2 q3bar: positive codes carry an up-type q2 as quark, a down-type q2 as antiquark
+        if (q2 == flavour && q3 == flavour) return 2;
+        if (q2 == flavour) return (flavour % 2 == 0) ? sign : -sign;
+        if (q3 == flavour) return (flavour % 2 == 0) ? -sign : sign;
+        return 0;
+    }
+    return (q1 == flavour || q2 == flavour || q3 == flavour) ? sign : 0;
+}
+
+// Per-candidate Higgs analysis shared by the tevmain and com*wjets generators: decay
+// products, invariant mass, jet clustering of the final state and jet matching of each
+// decay product, written as one CSV row.
+// The final state is built and the decay products are traced once per candidate; every
+// configured jet definition is then clustered from that shared input, in parallel on a
+// TaskPool when there are spare cores, and contributes its own block of jet columns.
+// In Ghost matching mode the decay products enter the clustering as ghosts (momentum scaled
+// by kGhostScale) with user_index -(d+1) instead of being traced, so the association comes
+// straight out of the clustering history; a product seeding several jets takes the leading one.
+// The clustering input is built once per event by beginEvent(), before its candidates. With a
+// detector configured (detectorResponse.h) it is the detector-level final state; particles
+// merged into a calorimeter tower take the jet of the tower.
+// With pileup subtraction on (pileupOverlay.h) the event's pT density rho is estimated once
+// per event as the median over a rapidity-phi grid, every definition clusters with
+// explicit ghosts on a fixed grid for the jet areas, and each jet keeps p - rho * A; jets
+// no longer above ptMin after subtraction are dropped. Unless FastJet was configured with
+// --enable-thread-safety (or --enable-limited-thread-safety), the area clusterings then run
+// one after the other on the calling thread.
+// One instance per worker. Every scratch buffer is a member that is cleared rather than
+// freed, so once the buffers have grown to the largest event the only heap traffic per
+// candidate is inside FastJet (ClusterSequence and its returned jet vector).
+class HiggsJetAnalysis {
+public:
+    explicit HiggsJetAnalysis(const std::vector<JetConfig>& configs, JetMatching matchingIn = JetMatching::Trace,
+                              const detector::Config& detectorConfig = detector::Config(),
+                              bool subtractPileupIn = false)
+        : matching(matchingIn),
+          clusterings(configs.begin(), configs.end()),
+          pool(TaskPool::helpersFor((subtractPileupIn && !kThreadSafeAreas) ? 1 : static_cast<int>(configs.size()))),
+          detector(detectorConfig),
+          subtractPileup(subtractPileupIn),
+          backgroundEstimator(kPileupRapMax, kPileupGridSpacing) {}
+
+    const detector::Response& detectorResponse() const { return detector; }
+
+    void writeHeader(std::ostream& out) const { Columns::writeHeader(out, *this); }
+
+    // Clustering input of the event (detector response, pileup density); call once per event,
+    // before writeCandidate() for any of its candidates
+    void beginEvent(const EventSnapshot& snap) {
+        memstats::StageScope clustering(memstats::Stage::Clustering);
+        detector.fill(snap, snap.eventIndex, particles);
+        nEventParticles = particles.size();
+        if (subtractPileup) {
+            alloccount::Pause fastjetInternals;
+            backgroundEstimator.set_particles(particles);
+            rho = backgroundEstimator.rho();
+        }
+    }
+
+    // Analyse the Higgs at snapshot index j of the event passed to beginEvent(); writes a row if it
+    // has at least two decay products
+    bool writeCandidate(const EventSnapshot& snap, int j, std::ostream& out) {
+        findDaughters(snap, j, daughterIndices);
+        if (daughterIndices.size() < 2) return false;
+
+        momenta.clear();
+        decayIds.clear();
+        for (int k : daughterIndices) {
+            momenta.push(snap.px[k], snap.py[k], snap.pz[k], snap.e[k]);
+            decayIds.push_back(snap.id[k]);
+        }
+
+        //Final state family tree (or ghosts), shared by all jet definitions
+        memstats::StageScope association(memstats::Stage::Association);
+        particles.resize(nEventParticles); // Drop the ghosts of the previous candidate
+        traced.clear();
+        tracedBegin.clear();
+        for (size_t d = 0; d < daughterIndices.size(); d++) {
+            tracedBegin.push_back(static_cast<int>(traced.size()));
+            if (matching == JetMatching::Trace) {
+                traceToFinalState(snap, daughterIndices[d], traced);
+            } else {
+                addGhosts(snap, daughterIndices[d], static_cast<int>(d));
+            }
+        }
+        tracedBegin.push_back(static_cast<int>(traced.size()));
+
+        ClusterTask task{this, snap.size()};
+        pool.run(static_cast<int>(clusterings.size()), task);
+
+        memstats::StageScope output(memstats::Stage::Output);
+        Columns::writeCsv(out, CandidateRow{snap.processCode, snap.eventIndex, decayIds,
+                                            kin::sumBatch(momenta).mCalc(), clusterings});
+        return true;
+    }
+
+    // Ghost momentum relative to its seed; far below any real particle, so jets are unchanged
+    static constexpr double kGhostScale = 1e-18;
+    // Jets softer than this contain nothing but ghosts
+    static constexpr double kGhostOnlyPt2 = 1e-20;
+    // Rapidity reach of the area ghosts and of the rho grid, and the grid cell size
+    static constexpr double kPileupRapMax = 5.0;
+    static constexpr double kPileupGridSpacing = 0.55;
+    // Ghost placement draws from FastJet's shared static random generator (even with zero
+    // scatter); it only tolerates concurrent area clusterings in a thread-safe FastJet build
+#if defined(FASTJET_HAVE_THREAD_SAFETY) || defined(FASTJET_HAVE_LIMITED_THREAD_SAFETY)
+    static constexpr bool kThreadSafeAreas = true;
+#else
+    static constexpr bool kThreadSafeAreas = false;
+#endif
+
+private:
+    // Ghost seeds of decay product `daughter`: the last B (C) hadrons carrying its b (c) quark,
+    // the last copy of a tau, or the decay product itself if nothing is found
+    void addGhosts(const EventSnapshot& snap, int daughter, int slot) {
+        const int id = snap.id[daughter];
+        const int idAbs = std::abs(id);
+        seeds.clear();
+        if (idAbs == 4 || idAbs == 5 || idAbs == 15) {
+            auto isSeedType = [&](int k) {
+                if (idAbs == 15) return snap.id[k] == id;
+                int content = heavyQuarkContent(snap.id[k], idAbs);
+                return content == 2 || content == (id > 0 ? 1 : -1);
+            };
+            auto isSameFlavour = [&](int k) {
+                return (idAbs == 15) ? std::abs(snap.id[k]) == 15 : heavyQuarkContent(snap.id[k], idAbs) != 0;
+            };
+            // Depth-first over descendants, visiting each entry once
+            if (visited.size() < static_cast<size_t>(snap.size())) visited.resize(snap.size(), 0);
+            if (++visitStamp == 0) {
+                std::fill(visited.begin(), visited.end(), 0);
+                visitStamp = 1;
+            }
+            stack.clear();
+            stack.push_back(daughter);
+            visited[daughter] = visitStamp;
+            while (!stack.empty()) {
+                int k = stack.back();
+                stack.pop_back();
+                bool lastOfChain = true;
+                forEachDaughter(snap, k, [&](int d) {
+                    if (d >= snap.size()) return;
+                    if (isSameFlavour(d)) lastOfChain = false;
+                    if (visited[d] != visitStamp) {
+                        visited[d] = visitStamp;
+                        stack.push_back(d);
+                    }
+                });
+                if (k != daughter && lastOfChain && isSeedType(k)) seeds.push_back(k);
+            }
+        }
+        if (seeds.empty()) seeds.push_back(daughter);
+
+        for (int k : seeds) {
+            fastjet::PseudoJet ghost(snap.px[k] * kGhostScale, snap.py[k] * kGhostScale,
+                                     snap.pz[k] * kGhostScale, snap.e[k] * kGhostScale);
+            ghost.set_user_index(-(slot + 1));
+            particles.push_back(ghost);
+        }
+    }
+
+    // Clustering state and output buffers of one jet definition
+    struct Clustering {
+        JetConfig config;
+        fastjet::JetDefinition jetDef;
+        std::vector<fastjet::PseudoJet> jets;
+        std::vector<int> histJet, particleJet, decayJet;
+        kin::MomentumBatch jetMomenta;
+        kin::JetKinematics jetKin;
+
+        Clustering(const JetConfig& configIn) : config(configIn), jetDef(configIn.definition()) {}
+
+        // Cluster and set decayJet[d] to the pT-ordered jet holding the last traced
+        // final-state descendant of decay product d, or -1. With rho >= 0 the jets are
+        // area-subtracted with that pT density.
+        void run(const std::vector<fastjet::PseudoJet>& particles, int eventSize, const std::vector<int>& traced,
+                 const std::vector<int>& tracedBegin, const std::vector<std::pair<int, int>>& aliases, double rho) {
+            alloccount::Scope countAllocs;
+            memstats::StageScope clustering(memstats::Stage::Clustering);
+            const size_t nDecays = tracedBegin.size() - 1;
+            decayJet.assign(nDecays, -1);
+            jetMomenta.clear();
+            if (particles.empty()) {
+                jetKin.compute(jetMomenta);
+                return;
+            }
+
+            alloccount::Pause fastjetInternals;
+            if (rho >= 0) {
+                fastjet::ClusterSequenceArea cs(particles, jetDef, areaDefinition());
+                jets = cs.inclusive_jets(config.ptMin);
+                subtract(rho);
+                fastjetInternals.resume();
+                associate(cs, particles, eventSize, traced, tracedBegin, aliases);
+            } else {
+                fastjet::ClusterSequence cs(particles, jetDef);
+                jets = cs.inclusive_jets(config.ptMin);
+                fastjetInternals.resume();
+                associate(cs, particles, eventSize, traced, tracedBegin, aliases);
+            }
+        }
+
+        // Explicit ghosts on a fixed grid: areas reproducible run to run, and the inputs
+        // still lead the clustering history as labelParticles expects
+        static fastjet::AreaDefinition areaDefinition() {
+            fastjet::GhostedAreaSpec ghosts(kPileupRapMax);
+            ghosts.set_grid_scatter(0.);
+            ghosts.set_pt_scatter(0.);
+            return fastjet::AreaDefinition(fastjet::active_area_explicit_ghosts, ghosts);
+        }
+
+        // p - rho * A on every jet, keeping its place in the clustering history
+        void subtract(double rho) {
+            fastjet::Subtractor subtractor(rho);
+            size_t kept = 0;
+            for (fastjet::PseudoJet& jet : jets) {
+                fastjet::PseudoJet corrected = subtractor(jet);
+                if (corrected.pt2() <= 0. || corrected.pt() < config.ptMin) continue;
+                jet.reset_momentum(corrected);
+                jets[kept++] = jet;
+            }
+            jets.resize(kept);
+        }
+
+        // Jet momenta and the decay product to jet association from the clustered jets
+        void associate(const fastjet::ClusterSequence& cs, const std::vector<fastjet::PseudoJet>& particles,
+                       int eventSize, const std::vector<int>& traced, const std::vector<int>& tracedBegin,
+                       const std::vector<std::pair<int, int>>& aliases) {
+            const size_t nDecays = tracedBegin.size() - 1;
+            std::sort(jets.begin(), jets.end(), [](const fastjet::PseudoJet& a, const fastjet::PseudoJet& b) {
+                return a.pt2() > b.pt2();
+            });
+            while (!jets.empty() && jets.back().pt2() < kGhostOnlyPt2) jets.pop_back();
+            memstats::StageScope association(memstats::Stage::Association);
+            labelParticles(cs, particles, eventSize);
+            for (const auto& alias : aliases) particleJet[alias.first] = particleJet[alias.second];
+
+            for (const auto& jet : jets) jetMomenta.push(jet.px(), jet.py(), jet.pz(), jet.e());
+            jetKin.compute(jetMomenta);
+
+            for (size_t d = 0; d < nDecays; d++) {
+                for (int t = tracedBegin[d]; t < tracedBegin[d + 1]; t++) {
+                    if (particleJet[traced[t]] >= 0) decayJet[d] = particleJet[traced[t]];
+                }
+            }
+        }
+
+        // particleJet[event index] = jet id, from the clustering history instead of per-jet
+        // constituents() vectors: every history entry inherits the jet of its child, and the
+        // first particles.size() entries are the inputs in order. Particles in no jet above
+        // ptMin keep -1. A ghost sets decayJet of its slot directly, keeping the leading jet.
+        void labelParticles(const fastjet::ClusterSequence& cs, const std::vector<fastjet::PseudoJet>& particles,
+                            int eventSize) {
+            const auto& history = cs.history();
+            histJet.assign(history.size(), -1);
+            for (size_t jetId = 0; jetId < jets.size(); jetId++) {
+                histJet[jets[jetId].cluster_hist_index()] = static_cast<int>(jetId);
+            }
+            for (int h = static_cast<int>(history.size()) - 1; h >= 0; h--) {
+                if (histJet[h] < 0 && history[h].child >= 0) histJet[h] = histJet[history[h].child];
+            }
+            particleJet.assign(eventSize, -1);
+            for (size_t i = 0; i < particles.size(); i++) {
+                int index = particles[i].user_index();
+                if (index >= 0) {
+                    particleJet[index] = histJet[i];
+                } else {
+                    int& slotJet = decayJet[-index - 1];
+                    if (histJet[i] >= 0 && (slotJet < 0 || histJet[i] < slotJet)) slotJet = histJet[i];
+                }
+            }
+        }
+
+        // Jet_PT, Jet_Eta, Jet_Phi, Jet_Mass and Jet_ID columns of this definition
+        void write(std::ostream& out) const {
+            const std::vector<double>* properties[] = {&jetKin.pt, &jetKin.eta, &jetKin.phi, &jetKin.m};
+            for (const std::vector<double>* property : properties) {
+                for (size_t d = 0; d < decayJet.size(); d++) {
+                    int jetId = decayJet[d];
+                    if (jetId >= 0) {
+                        out << (*property)[jetId];
+                    } else {
+                        out << "-1"; //-1 if decay doesnt trace to any jet
+                    }
+                    if (d != 1) out << ";";
+                }
+                out << ",";
+            }
+
+            // Jet ID for each decay product
+            for (size_t d = 0; d < decayJet.size(); d++) {
+                out << decayJet[d];
+                if (d != 1) out << ";";
+            }
+        }
+    };
+
+    struct ClusterTask {
+        HiggsJetAnalysis* analysis;
+        int eventSize;
+        void operator()(int c) {
+            analysis->clusterings[c].run(analysis->particles, eventSize, analysis->traced, analysis->tracedBegin,
+                                         analysis->detector.aliases(), analysis->subtractPileup ? analysis->rho : -1.);
+        }
+    };
+
+    // Output row of one candidate
+    struct CandidateRow {
+        int processCode;
+        long eventIndex;
+        const std::vector<int>& decayIds;
+        double invMass;
+        const std::vector<Clustering>& clusterings;
+    };
+
+    // Five jet columns per jet definition; a single definition keeps the original column names
+    struct JetColumns : schema::Column<JetColumns> {
+        static void header(std::ostream& out, const HiggsJetAnalysis& analysis) {
+            const char* separator = "";
+            for (const Clustering& clustering : analysis.clusterings) {
+                std::string suffix = (analysis.clusterings.size() > 1) ? "_" + clustering.config.label : "";
+                out << separator << "Jet_PT" << suffix << ",Jet_Eta" << suffix << ",Jet_Phi" << suffix
+                    << ",Jet_Mass" << suffix << ",Jet_ID" << suffix;
+                separator = ",";
+            }
+        }
+
+        static void csv(std::ostream& out, const CandidateRow& row) {
+            const char* separator = "";
+            for (const Clustering& clustering : row.clusterings) {
+                out << separator;
+                clustering.write(out);
+                separator = ",";
+            }
+        }
+    };
+
+    using Columns = schema::Schema<schema::ProductionChannel, schema::DecayProducts, schema::InvMasses, JetColumns,
+                                   schema::EventIndex>;
+
+    JetMatching matching;
+    std::vector<Clustering> clusterings;
+    TaskPool pool;
+    std::vector<int> daughterIndices, decayIds, traced, tracedBegin;
+    std::vector<int> seeds, stack;
+    std::vector<unsigned> visited;
+    unsigned visitStamp = 0;
+    std::vector<fastjet::PseudoJet> particles; // Event's clustering input, then the candidate's ghosts
+    size_t nEventParticles = 0;
+    kin::MomentumBatch momenta;
+    detector::Response detector;
+    bool subtractPileup;
+    double rho = 0.; // Pileup pT density of the current event, GeV per unit area
+    fastjet::GridMedianBackgroundEstimator backgroundEstimator;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef JET_CONFIG_H
+#define JET_CONFIG_H
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "fastjet/ClusterSequence.hh"
+
+// One jet definition requested on the command line: algorithm, radius and minimum jet pT.
+// The label suffixes the output columns when more than one definition is clustered,
+// e.g. antikt:1.0:200 -> Jet_PT_akt10_pt200.
+struct JetConfig {
+    fastjet::JetAlgorithm algorithm = fastjet::antikt_algorithm;
+    double R = 0.4;
+    double ptMin = 0.;
+    std::string label = "akt04";
+
+    fastjet::JetDefinition definition() const { return fastjet::JetDefinition(algorithm, R); }
+};
+
+// Parse "alg:R[:ptmin],alg:R[:ptmin],..." with alg one of antikt, kt, cambridge (or ca)
+inline bool parseJetConfigs(const std::string& spec, std::vector<JetConfig>& configs) {
+    configs.clear();
+    std::stringstream list(spec);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        std::stringstream fields(item);
+        std::string alg, radius, ptMin;
+        std::getline(fields, alg, ':');
+        std::getline(fields, radius, ':');
+        std::getline(fields, ptMin, ':');
+
+        JetConfig config;
+        std::string prefix;
+        if (alg == "antikt") {
+            config.algorithm = fastjet::antikt_algorithm;
+            prefix = "akt";
+        } else if (alg == "kt") {
+            config.algorithm = fastjet::kt_algorithm;
+            prefix = "kt";
+        } else if (alg == "cambridge" || alg == "ca") {
+            config.algorithm = fastjet::cambridge_algorithm;
+            prefix = "ca";
+        } else {
+            std::cerr << "Error: Unknown jet algorithm '" << alg << "' in " << item << std::endl;
+            return false;
+        }
+        try {
+            config.R = std::stod(radius);
+            config.ptMin = ptMin.empty() ? 0. : std::stod(ptMin);
+        } catch (const std::exception&) {
+            std::cerr << "Error: Could not parse jet definition " << item << " (expected alg:R[:ptmin])" << std::endl;
+            return false;
+        }
+        if (config.R <= 0.) {
+            std::cerr << "Error: Jet radius must be positive in " << item << std::endl;
+            return false;
+        }
+
+        char radiusTag[16];
+        std::snprintf(radiusTag, sizeof(radiusTag), "%02d", static_cast<int>(config.R * 10. + 0.5));
+        config.label = prefix + radiusTag;
+        if (config.ptMin > 0.) config.label += "_pt" + std::to_string(static_cast<int>(config.ptMin + 0.5));
+        // Labels round R to 0.1 and ptMin to 1 GeV; two definitions sharing one would share columns
+        for (const JetConfig& other : configs) {
+            if (other.label == config.label) {
+                std::cerr << "Error: Jet definition " << item << " has the same column label (" << config.label
+                          << ") as an earlier one" << std::endl;
+                return false;
+            }
+        }
+        configs.push_back(config);
+    }
+    if (configs.empty()) {
+        std::cerr << "Error: Empty jet definition list" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#endif
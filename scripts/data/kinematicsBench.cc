@@ -0,0 +1,116 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include "Pythia8/Pythia.h"
+#include "kinematicsKernels.h"
+
+using namespace Pythia8;
+
+// Checks the batch kinematics kernels against Pythia's scalar Vec4 and times both.
+// Build once with -mavx2 -mfma and once without to compare the AVX2 and scalar paths.
+
+// Random final-state-like momenta: massless to hadron masses, wide rapidity range
+void makeBatch(int n, std::mt19937_64& rng, kin::MomentumBatch& batch, std::vector<Vec4>& vecs) {
+    std::uniform_real_distribution<double> ptDist(0.1, 500.), yDist(-8., 8.), phiDist(-M_PI, M_PI), mDist(0., 1.);
+    batch.clear();
+    vecs.clear();
+    for (int i = 0; i < n; i++) {
+        double pT = ptDist(rng), y = yDist(rng), phi = phiDist(rng), m = mDist(rng);
+        double mT = std::sqrt(pT * pT + m * m);
+        Vec4 p(pT * std::cos(phi), pT * std::sin(phi), mT * std::sinh(y), mT * std::cosh(y));
+        batch.push(p.px(), p.py(), p.pz(), p.e());
+        vecs.push_back(p);
+    }
+}
+
+double relErr(double a, double b) {
+    return std::abs(a - b) / std::max(1.0, std::abs(b));
+}
+
+int main(int argc, char* argv[]) {
+    int nParticles = (argc > 1) ? std::stoi(argv[1]) : 4000;
+    int nRepeat = (argc > 2) ? std::stoi(argv[2]) : 2000;
+
+#ifdef __AVX2__
+    std::cout << "Kernels: AVX2" << std::endl;
+#else
+    std::cout << "Kernels: scalar fallback" << std::endl;
+#endif
+
+    std::mt19937_64 rng(12345);
+    kin::MomentumBatch batch;
+    std::vector<Vec4> vecs;
+    makeBatch(nParticles, rng, batch, vecs);
+
+    // Correctness against Vec4
+    std::vector<double> pt(nParticles), y(nParticles), eta(nParticles), phi(nParticles), m(nParticles);
+    kin::ptBatch(batch.px.data(), batch.py.data(), pt.data(), nParticles);
+    kin::rapidityBatch(batch.pz.data(), batch.e.data(), y.data(), nParticles);
+    kin::etaBatch(batch.px.data(), batch.py.data(), batch.pz.data(), eta.data(), nParticles);
+    kin::phiBatch(batch.px.data(), batch.py.data(), phi.data(), nParticles);
+    kin::massBatch(batch.px.data(), batch.py.data(), batch.pz.data(), batch.e.data(), m.data(), nParticles);
+    kin::Sum4 sum = kin::sumBatch(batch);
+
+    double maxPt = 0., maxY = 0., maxEta = 0., maxPhi = 0., maxM = 0.;
+    Vec4 total;
+    for (int i = 0; i < nParticles; i++) {
+        maxPt = std::max(maxPt, relErr(pt[i], vecs[i].pT()));
+        maxY = std::max(maxY, relErr(y[i], vecs[i].rap()));
+        maxEta = std::max(maxEta, relErr(eta[i], vecs[i].eta()));
+        maxPhi = std::max(maxPhi, relErr(phi[i], vecs[i].phi()));
+        // E^2 - p^2 cancels badly at high |y|, so compare signed m^2 on the scale of E^2
+        double mRef = vecs[i].mCalc();
+        maxM = std::max(maxM, std::abs(m[i] * std::abs(m[i]) - mRef * std::abs(mRef)) / std::max(1.0, vecs[i].e() * vecs[i].e()));
+        total += vecs[i];
+    }
+    double maxSum = std::max({relErr(sum.px, total.px()), relErr(sum.py, total.py()),
+                              relErr(sum.pz, total.pz()), relErr(sum.e, total.e())});
+    double sumMassErr = relErr(sum.mCalc(), total.mCalc());
+
+    std::cout << "Max relative error vs Vec4: pT " << maxPt << ", rap " << maxY << ", eta " << maxEta
+              << ", phi " << maxPhi << ", mass " << maxM << ", sum " << maxSum << ", sum mass " << sumMassErr << std::endl;
+    bool ok = maxPt < 1e-12 && maxY < 1e-10 && maxEta < 1e-10 && maxPhi < 1e-12 && maxM < 1e-14
+           && maxSum < 1e-10 && sumMassErr < 1e-8;
+
+    // Timing: scalar Vec4 loop vs batch kernels over the same particles
+    using clock = std::chrono::steady_clock;
+    double sink = 0.;
+    auto t0 = clock::now();
+    for (int r = 0; r < nRepeat; r++) {
+        Vec4 acc;
+        for (int i = 0; i < nParticles; i++) {
+            pt[i] = vecs[i].pT();
+            y[i] = vecs[i].rap();
+            phi[i] = vecs[i].phi();
+            m[i] = vecs[i].mCalc();
+            acc += vecs[i];
+        }
+        sink += acc.e() + pt[r % nParticles] + y[r % nParticles] + phi[r % nParticles] + m[r % nParticles];
+    }
+    auto t1 = clock::now();
+    for (int r = 0; r < nRepeat; r++) {
+        kin::ptBatch(batch.px.data(), batch.py.data(), pt.data(), nParticles);
+        kin::rapidityBatch(batch.pz.data(), batch.e.data(), y.data(), nParticles);
+        kin::phiBatch(batch.px.data(), batch.py.data(), phi.data(), nParticles);
+        kin::massBatch(batch.px.data(), batch.py.data(), batch.pz.data(), batch.e.data(), m.data(), nParticles);
+        sink += kin::sumBatch(batch).e + pt[r % nParticles] + y[r % nParticles] + phi[r % nParticles] + m[r % nParticles];
+    }
+    auto t2 = clock::now();
+
+    double tVec4 = std::chrono::duration<double>(t1 - t0).count();
+    double tBatch = std::chrono::duration<double>(t2 - t1).count();
+    double nTotal = double(nParticles) * nRepeat;
+    std::cout << "Vec4 scalar:   " << nTotal / tVec4 / 1e6 << " Mparticles/s" << std::endl;
+    std::cout << "Batch kernels: " << nTotal / tBatch / 1e6 << " Mparticles/s" << std::endl;
+    std::cout << "Speedup: " << tVec4 / tBatch << "x (checksum " << sink << ")" << std::endl;
+
+    if (!ok) {
+        std::cerr << "Error: batch kernels disagree with Vec4 beyond tolerance." << std::endl;
+        return 1;
+    }
+    return 0;
+}
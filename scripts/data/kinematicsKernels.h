@@ -0,0 +1,274 @@
+#ifndef KINEMATICS_KERNELS_H
+#define KINEMATICS_KERNELS_H
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Batch kinematics over structure-of-arrays momenta (px, py, pz, e).
+// Compiled with -mavx2 -mfma (or -march=native on an AVX2 machine) the kernels process four
+// particles per instruction; otherwise the scalar loops below are used. Results follow
+// Pythia's Vec4 conventions: phi = atan2(py, px) in (-pi, pi], negative mass for spacelike
+// four-vectors. kinematicsBench.cc checks both paths against Vec4.
+namespace kin {
+
+// Momentum components of a batch of particles or jets, reused between events
+struct MomentumBatch {
+    std::vector<double> px, py, pz, e;
+
+    std::size_t size() const { return px.size(); }
+    void clear() { px.clear(); py.clear(); pz.clear(); e.clear(); }
+    void push(double pxIn, double pyIn, double pzIn, double eIn) {
+        px.push_back(pxIn); py.push_back(pyIn); pz.push_back(pzIn); e.push_back(eIn);
+    }
+};
+
+// Summed four-vector of a batch
+struct Sum4 {
+    double px = 0., py = 0., pz = 0., e = 0.;
+    double mCalc() const {
+        double m2 = e * e - px * px - py * py - pz * pz;
+        return (m2 >= 0.) ? std::sqrt(m2) : -std::sqrt(-m2);
+    }
+};
+
+// Floor for transverse momentum/mass in rapidities, as Pythia's TINY
+constexpr double kTiny = 1e-20;
+constexpr double kPi = 3.14159265358979323846;
+
+// Scalar reference versions, also used for the loop remainders
+namespace scalar {
+    inline double pt(double px, double py) { return std::sqrt(px * px + py * py); }
+    inline double phi(double px, double py) { return std::atan2(py, px); }
+    inline double mass(double px, double py, double pz, double e) {
+        double m2 = e * e - px * px - py * py - pz * pz;
+        return (m2 >= 0.) ? std::sqrt(m2) : -std::sqrt(-m2);
+    }
+    inline double rapidity(double pz, double e) {
+        double mT2 = e * e - pz * pz;
+        double mT = std::sqrt(mT2 > kTiny * kTiny ? mT2 : kTiny * kTiny);
+        double y = std::log((e + std::abs(pz)) / mT);
+        return (pz >= 0.) ? y : -y;
+    }
+    inline double eta(double px, double py, double pz) {
+        double pT = std::sqrt(px * px + py * py);
+        double pAbs = std::sqrt(px * px + py * py + pz * pz);
+        double eta = std::log((pAbs + std::abs(pz)) / (pT > kTiny ? pT : kTiny));
+        return (pz >= 0.) ? eta : -eta;
+    }
+}
+
+#ifdef __AVX2__
+namespace avx2 {
+    inline __m256d abs(__m256d x) { return _mm256_andnot_pd(_mm256_set1_pd(-0.), x); }
+    inline __m256d sign(__m256d x) { return _mm256_and_pd(_mm256_set1_pd(-0.), x); }
+
+    // Natural log for positive finite input (Cephes log, ~1 ulp)
+    inline __m256d log(__m256d x) {
+        const __m256i bits = _mm256_castpd_si256(x);
+        // Exponent as double via the 2^52 bias trick; mantissa rescaled into [0.5, 1)
+        const __m256d two52 = _mm256_set1_pd(4503599627370496.);
+        __m256d expo = _mm256_sub_pd(
+            _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_castpd_si256(two52))), two52);
+        expo = _mm256_sub_pd(expo, _mm256_set1_pd(1022.));
+        __m256d m = _mm256_castsi256_pd(_mm256_or_si256(
+            _mm256_and_si256(bits, _mm256_set1_epi64x(0x000fffffffffffffLL)),
+            _mm256_set1_epi64x(0x3fe0000000000000LL)));
+
+        const __m256d small = _mm256_cmp_pd(m, _mm256_set1_pd(0.70710678118654752440), _CMP_LT_OQ);
+        const __m256d one = _mm256_set1_pd(1.);
+        expo = _mm256_sub_pd(expo, _mm256_and_pd(small, one));
+        __m256d xr = _mm256_sub_pd(_mm256_add_pd(m, _mm256_and_pd(small, m)), one);
+
+        __m256d z = _mm256_mul_pd(xr, xr);
+        __m256d p = _mm256_set1_pd(1.01875663804580931796E-4);
+        p = _mm256_fmadd_pd(p, xr, _mm256_set1_pd(4.97494994976747001425E-1));
+        p = _mm256_fmadd_pd(p, xr, _mm256_set1_pd(4.70579119878881725854E0));
+        p = _mm256_fmadd_pd(p, xr, _mm256_set1_pd(1.44989225341610930846E1));
+        p = _mm256_fmadd_pd(p, xr, _mm256_set1_pd(1.79368678507819816313E1));
+        p = _mm256_fmadd_pd(p, xr, _mm256_set1_pd(7.70838733755885391666E0));
+        __m256d q = _mm256_add_pd(xr, _mm256_set1_pd(1.12873587189167450590E1));
+        q = _mm256_fmadd_pd(q, xr, _mm256_set1_pd(4.52279145837532221105E1));
+        q = _mm256_fmadd_pd(q, xr, _mm256_set1_pd(8.29875266912776603211E1));
+        q = _mm256_fmadd_pd(q, xr, _mm256_set1_pd(7.11544750618563894466E1));
+        q = _mm256_fmadd_pd(q, xr, _mm256_set1_pd(2.31251620126765340583E1));
+
+        __m256d y = _mm256_mul_pd(xr, _mm256_div_pd(_mm256_mul_pd(z, p), q));
+        y = _mm256_fmadd_pd(expo, _mm256_set1_pd(-2.121944400546905827679e-4), y);
+        y = _mm256_fnmadd_pd(_mm256_set1_pd(0.5), z, y);
+        __m256d r = _mm256_add_pd(xr, y);
+        return _mm256_fmadd_pd(expo, _mm256_set1_pd(0.693359375), r);
+    }
+
+    // Arctangent (Cephes atan, ~1 ulp)
+    inline __m256d atan(__m256d x) {
+        const __m256d sgn = sign(x);
+        __m256d ax = abs(x);
+        const __m256d big = _mm256_cmp_pd(ax, _mm256_set1_pd(2.41421356237309504880), _CMP_GT_OQ);
+        const __m256d mid = _mm256_andnot_pd(big, _mm256_cmp_pd(ax, _mm256_set1_pd(0.66), _CMP_GT_OQ));
+        const __m256d one = _mm256_set1_pd(1.);
+
+        __m256d xr = _mm256_blendv_pd(ax, _mm256_div_pd(_mm256_set1_pd(-1.), ax), big);
+        xr = _mm256_blendv_pd(xr, _mm256_div_pd(_mm256_sub_pd(ax, one), _mm256_add_pd(ax, one)), mid);
+        __m256d y0 = _mm256_or_pd(_mm256_and_pd(big, _mm256_set1_pd(kPi / 2.)),
+                                  _mm256_and_pd(mid, _mm256_set1_pd(kPi / 4.)));
+        const __m256d moreBits = _mm256_or_pd(_mm256_and_pd(big, _mm256_set1_pd(6.123233995736765886130E-17)),
+                                              _mm256_and_pd(mid, _mm256_set1_pd(0.5 * 6.123233995736765886130E-17)));
+
+        __m256d z = _mm256_mul_pd(xr, xr);
+        __m256d p = _mm256_set1_pd(-8.750608600031904122785E-1);
+        p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(-1.615753718733365076637E1));
+        p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(-7.500855792314704667340E1));
+        p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(-1.228866684490136173410E2));
+        p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(-6.485021904942025371773E1));
+        __m256d q = _mm256_add_pd(z, _mm256_set1_pd(2.485846490142306297962E1));
+        q = _mm256_fmadd_pd(q, z, _mm256_set1_pd(1.650270098316988542046E2));
+        q = _mm256_fmadd_pd(q, z, _mm256_set1_pd(4.328810604912902668951E2));
+        q = _mm256_fmadd_pd(q, z, _mm256_set1_pd(4.853903996359136964868E2));
+        q = _mm256_fmadd_pd(q, z, _mm256_set1_pd(1.945506571482613964425E2));
+
+        __m256d r = _mm256_mul_pd(z, _mm256_div_pd(p, q));
+        r = _mm256_fmadd_pd(xr, r, xr);
+        r = _mm256_add_pd(_mm256_add_pd(y0, r), moreBits);
+        return _mm256_xor_pd(r, sgn);
+    }
+
+    // atan2(y, x) in (-pi, pi], 0 for the origin
+    inline __m256d atan2(__m256d y, __m256d x) {
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d xZero = _mm256_cmp_pd(x, zero, _CMP_EQ_OQ);
+        __m256d r = atan(_mm256_div_pd(y, x));
+        r = _mm256_blendv_pd(r, _mm256_or_pd(_mm256_set1_pd(kPi / 2.), sign(y)), xZero);
+        const __m256d xNeg = _mm256_cmp_pd(x, zero, _CMP_LT_OQ);
+        const __m256d shift = _mm256_or_pd(_mm256_set1_pd(kPi), sign(y));
+        r = _mm256_add_pd(r, _mm256_and_pd(xNeg, shift));
+        const __m256d origin = _mm256_and_pd(xZero, _mm256_cmp_pd(y, zero, _CMP_EQ_OQ));
+        return _mm256_andnot_pd(origin, r);
+    }
+}
+#endif
+
+inline void ptBatch(const double* px, const double* py, double* pt, std::size_t n) {
+    std::size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(px + i), y = _mm256_loadu_pd(py + i);
+        _mm256_storeu_pd(pt + i, _mm256_sqrt_pd(_mm256_fmadd_pd(x, x, _mm256_mul_pd(y, y))));
+    }
+#endif
+    for (; i < n; i++) pt[i] = scalar::pt(px[i], py[i]);
+}
+
+// Azimuth in (-pi, pi]; with zeroToTwoPi the FastJet PseudoJet::phi() range [0, 2pi) instead
+inline void phiBatch(const double* px, const double* py, double* phi, std::size_t n, bool zeroToTwoPi = false) {
+    std::size_t i = 0;
+#ifdef __AVX2__
+    const __m256d twoPi = _mm256_set1_pd(2. * kPi);
+    for (; i + 4 <= n; i += 4) {
+        __m256d r = avx2::atan2(_mm256_loadu_pd(py + i), _mm256_loadu_pd(px + i));
+        if (zeroToTwoPi) {
+            r = _mm256_add_pd(r, _mm256_and_pd(_mm256_cmp_pd(r, _mm256_setzero_pd(), _CMP_LT_OQ), twoPi));
+        }
+        _mm256_storeu_pd(phi + i, r);
+    }
+#endif
+    for (; i < n; i++) {
+        phi[i] = scalar::phi(px[i], py[i]);
+        if (zeroToTwoPi && phi[i] < 0.) phi[i] += 2. * kPi;
+    }
+}
+
+inline void massBatch(const double* px, const double* py, const double* pz, const double* e,
+                      double* m, std::size_t n) {
+    std::size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(px + i), y = _mm256_loadu_pd(py + i);
+        __m256d z = _mm256_loadu_pd(pz + i), t = _mm256_loadu_pd(e + i);
+        __m256d p2 = _mm256_fmadd_pd(x, x, _mm256_fmadd_pd(y, y, _mm256_mul_pd(z, z)));
+        __m256d m2 = _mm256_fmsub_pd(t, t, p2);
+        _mm256_storeu_pd(m + i, _mm256_or_pd(_mm256_sqrt_pd(avx2::abs(m2)), avx2::sign(m2)));
+    }
+#endif
+    for (; i < n; i++) m[i] = scalar::mass(px[i], py[i], pz[i], e[i]);
+}
+
+inline void rapidityBatch(const double* pz, const double* e, double* y, std::size_t n) {
+    std::size_t i = 0;
+#ifdef __AVX2__
+    const __m256d tiny2 = _mm256_set1_pd(kTiny * kTiny);
+    for (; i + 4 <= n; i += 4) {
+        __m256d z = _mm256_loadu_pd(pz + i), t = _mm256_loadu_pd(e + i);
+        __m256d mT = _mm256_sqrt_pd(_mm256_max_pd(_mm256_fmsub_pd(t, t, _mm256_mul_pd(z, z)), tiny2));
+        __m256d r = avx2::log(_mm256_div_pd(_mm256_add_pd(t, avx2::abs(z)), mT));
+        _mm256_storeu_pd(y + i, _mm256_xor_pd(r, avx2::sign(z)));
+    }
+#endif
+    for (; i < n; i++) y[i] = scalar::rapidity(pz[i], e[i]);
+}
+
+// Pseudorapidity
+inline void etaBatch(const double* px, const double* py, const double* pz, double* eta, std::size_t n) {
+    std::size_t i = 0;
+#ifdef __AVX2__
+    const __m256d tiny = _mm256_set1_pd(kTiny);
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(px + i), y = _mm256_loadu_pd(py + i), z = _mm256_loadu_pd(pz + i);
+        __m256d pT2 = _mm256_fmadd_pd(x, x, _mm256_mul_pd(y, y));
+        __m256d pT = _mm256_max_pd(_mm256_sqrt_pd(pT2), tiny);
+        __m256d pAbs = _mm256_sqrt_pd(_mm256_fmadd_pd(z, z, pT2));
+        __m256d r = avx2::log(_mm256_div_pd(_mm256_add_pd(pAbs, avx2::abs(z)), pT));
+        _mm256_storeu_pd(eta + i, _mm256_xor_pd(r, avx2::sign(z)));
+    }
+#endif
+    for (; i < n; i++) eta[i] = scalar::eta(px[i], py[i], pz[i]);
+}
+
+inline Sum4 sumBatch(const double* px, const double* py, const double* pz, const double* e, std::size_t n) {
+    Sum4 sum;
+    std::size_t i = 0;
+#ifdef __AVX2__
+    __m256d sx = _mm256_setzero_pd(), sy = _mm256_setzero_pd();
+    __m256d sz = _mm256_setzero_pd(), st = _mm256_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        sx = _mm256_add_pd(sx, _mm256_loadu_pd(px + i));
+        sy = _mm256_add_pd(sy, _mm256_loadu_pd(py + i));
+        sz = _mm256_add_pd(sz, _mm256_loadu_pd(pz + i));
+        st = _mm256_add_pd(st, _mm256_loadu_pd(e + i));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, sx); sum.px = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_store_pd(lanes, sy); sum.py = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_store_pd(lanes, sz); sum.pz = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_store_pd(lanes, st); sum.e = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < n; i++) {
+        sum.px += px[i]; sum.py += py[i]; sum.pz += pz[i]; sum.e += e[i];
+    }
+    return sum;
+}
+
+inline Sum4 sumBatch(const MomentumBatch& batch) {
+    return sumBatch(batch.px.data(), batch.py.data(), batch.pz.data(), batch.e.data(), batch.size());
+}
+
+// Jet-style outputs for a whole batch: pt, pseudorapidity, FastJet-range phi, mass
+struct JetKinematics {
+    std::vector<double> pt, eta, phi, m;
+
+    void compute(const MomentumBatch& batch) {
+        const std::size_t n = batch.size();
+        pt.resize(n); eta.resize(n); phi.resize(n); m.resize(n);
+        ptBatch(batch.px.data(), batch.py.data(), pt.data(), n);
+        etaBatch(batch.px.data(), batch.py.data(), batch.pz.data(), eta.data(), n);
+        phiBatch(batch.px.data(), batch.py.data(), phi.data(), n, true);
+        massBatch(batch.px.data(), batch.py.data(), batch.pz.data(), batch.e.data(), m.data(), n);
+    }
+};
+
+}
+
+#endif
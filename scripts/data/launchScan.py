@@ -0,0 +1,247 @@
+import argparse
+import glob
+import json
+import math
+import os
+import re
+import shutil
+import subprocess
+import sys
+import threading
+import time
+
+# Cost-aware launcher for energy scans. Each job (a generator at one energy and its requested
+# event total) is split into shards sized by its measured cost, so every core finishes at about
+# the same time instead of the 100 TeV jobs running for hours after the rest:
+#   1. cost per job in events/s plus Pythia init seconds, from a short seeded calibration run of
+#      the binary or from a costs file saved by an earlier launch;
+#   2. each job cut into event ranges of roughly equal wall time, placed longest first on the
+#      least loaded worker;
+#   3. one worker per core (or NUMA node), its shards pinned with taskset (or sched_setaffinity on
+#      the child when taskset is missing) and run in sequence;
+#   4. shard outputs merged per job and the achieved utilization reported.
+# All shards of a job share one run seed and take disjoint --event ranges, so thanks to the
+# counter-based seeding the merged output holds exactly the events of one unsharded run.
+#
+# Jobs:  tevmain:<TeV>:<events>   or   <comXwjets>:<events>
+
+RATE_PATTERN = re.compile(r"([0-9.eE+-]+) events/s")
+# Workers are threads, so the affinity is not set from a preexec_fn, which is unsafe with threads
+TASKSET = shutil.which("taskset")
+
+
+class Job:
+    def __init__(self, spec):
+        parts = spec.split(":")
+        if parts[0] == "tevmain" and len(parts) == 3:
+            self.program, self.energy, self.events = parts[0], parts[1], int(parts[2])
+            self.name = f"tevmain_{self.energy}tev"
+        elif parts[0] != "tevmain" and len(parts) == 2:
+            self.program, self.energy, self.events = parts[0], None, int(parts[1])
+            self.name = self.program
+        else:
+            raise ValueError(f"bad job '{spec}' (use tevmain:<TeV>:<events> or <program>:<events>)")
+        self.key = f"{self.program}:{self.energy}" if self.energy else self.program
+        self.rate = None
+        self.init_seconds = 0.0
+
+    def command(self, bin_dir, output, seed, first, last, calibrate_events=None):
+        binary = os.path.join(bin_dir, self.program)
+        if calibrate_events is not None:
+            if self.energy:
+                return [binary, f"{self.energy}:{calibrate_events}:{output}", "--seed", str(seed)]
+            return [binary, output, "--seed", str(seed), "--nevents", str(calibrate_events)]
+        events = ["--seed", str(seed), "--event", f"{first}-{last - 1}"]
+        if self.energy:
+            return [binary, f"{self.energy}:{last - first}:{output}"] + events
+        return [binary, output] + events
+
+    def seconds(self, n_events):
+        return self.init_seconds + n_events / self.rate
+
+
+def calibrate(job, bin_dir, work_dir, n_events, seed):
+    output = os.path.join(work_dir, f"calibrate_{job.name}.csv")
+    start = time.time()
+    result = subprocess.run(job.command(bin_dir, output, seed, 0, 0, calibrate_events=n_events),
+                            capture_output=True, text=True)
+    wall = time.time() - start
+    if os.path.exists(output):
+        os.remove(output)
+    rates = RATE_PATTERN.findall(result.stdout)
+    if result.returncode != 0 or not rates:
+        raise RuntimeError(f"calibration of {job.key} failed:\n{result.stderr}")
+    job.rate = float(rates[-1])
+    job.init_seconds = max(0.0, wall - n_events / job.rate)
+    print(f"Calibrated {job.key}: {job.rate:.2f} events/s, {job.init_seconds:.1f} s init")
+
+
+def make_shards(jobs, n_workers, granularity):
+    """Event ranges of each job of about (total time / workers / granularity) seconds, longest first"""
+    total = sum(job.seconds(job.events) for job in jobs)
+    shard_seconds = total / (n_workers * granularity)
+    shards = []
+    for job in jobs:
+        n_shards = max(1, min(job.events, round(job.seconds(job.events) / shard_seconds)))
+        # Every extra shard pays the init again; stop splitting once that dominates
+        while n_shards > 1 and job.init_seconds > 0.5 * job.seconds(job.events / n_shards):
+            n_shards -= 1
+        bounds = [job.events * k // n_shards for k in range(n_shards + 1)]
+        for k in range(n_shards):
+            shards.append({"job": job, "index": k, "first": bounds[k], "last": bounds[k + 1],
+                           "estimate": job.seconds(bounds[k + 1] - bounds[k])})
+    shards.sort(key=lambda shard: shard["estimate"], reverse=True)
+    return shards
+
+
+def assign(shards, n_workers):
+    """Longest processing time first: each shard goes to the worker with the least work so far"""
+    queues = [[] for _ in range(n_workers)]
+    loads = [0.0] * n_workers
+    for shard in shards:
+        w = loads.index(min(loads))
+        queues[w].append(shard)
+        loads[w] += shard["estimate"]
+    return queues, loads
+
+
+def cpu_sets(per_numa_node):
+    allowed = sorted(os.sched_getaffinity(0))
+    if not per_numa_node:
+        return [{cpu} for cpu in allowed]
+    sets = []
+    for node in sorted(glob.glob("/sys/devices/system/node/node[0-9]*/cpulist")):
+        with open(node) as f:
+            cpus = set()
+            for part in f.read().strip().split(","):
+                if "-" in part:
+                    a, b = part.split("-")
+                    cpus.update(range(int(a), int(b) + 1))
+                elif part:
+                    cpus.add(int(part))
+        cpus &= set(allowed)
+        if cpus:
+            sets.append(cpus)
+    return sets or [set(allowed)]
+
+
+def run_worker(w, cpus, queue, args, stats):
+    busy = 0.0
+    cpu_time = 0.0
+    start = time.time()
+    for shard in queue:
+        job = shard["job"]
+        shard["output"] = os.path.join(args.out_dir, f"{job.name}_{shard['index']:03d}.csv")
+        log = open(shard["output"][:-4] + ".log", "w")
+        command = job.command(args.bin_dir, shard["output"], args.seed, shard["first"], shard["last"])
+        shard_start = time.time()
+        if TASKSET:
+            command = [TASKSET, "-c", ",".join(str(cpu) for cpu in sorted(cpus))] + command
+        process = subprocess.Popen(command, stdout=log, stderr=subprocess.STDOUT)
+        if not TASKSET:
+            os.sched_setaffinity(process.pid, cpus)
+        _, status, usage = os.wait4(process.pid, 0)
+        process.returncode = os.waitstatus_to_exitcode(status)
+        log.close()
+        shard["seconds"] = time.time() - shard_start
+        shard["ok"] = process.returncode == 0
+        busy += shard["seconds"]
+        cpu_time += usage.ru_utime + usage.ru_stime
+        if not shard["ok"]:
+            print(f"Worker {w}: {job.name} shard {shard['index']} failed, see {shard['output'][:-4]}.log")
+    stats[w] = {"busy": busy, "cpu": cpu_time, "finished": time.time() - start, "shards": len(queue)}
+
+
+def merge(jobs, shards, out_dir):
+    for job in jobs:
+        parts = sorted((s for s in shards if s["job"] is job), key=lambda s: s["index"])
+        if not all(s.get("ok") for s in parts):
+            print(f"{job.name}: not merged, a shard failed")
+            continue
+        merged = os.path.join(out_dir, f"{job.name}.csv")
+        with open(merged, "w") as out:
+            for k, shard in enumerate(parts):
+                with open(shard["output"]) as f:
+                    header = f.readline()
+                    if k == 0:
+                        out.write(header)
+                    for line in f:
+                        out.write(line)
+                os.remove(shard["output"])
+        print(f"{job.name}: {len(parts)} shards -> {merged}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Cost-balanced, CPU-pinned launcher for energy scans")
+    parser.add_argument("jobs", nargs="+", help="tevmain:<TeV>:<events> or <comXwjets>:<events>")
+    parser.add_argument("--bin-dir", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "build", "release"))
+    parser.add_argument("--out-dir", default=".")
+    parser.add_argument("--seed", type=int, default=int.from_bytes(os.urandom(4), "little"))
+    parser.add_argument("--workers", type=int, default=0, help="default: one per allowed core (or NUMA node)")
+    parser.add_argument("--numa", action="store_true", help="pin workers to NUMA nodes instead of single cores")
+    parser.add_argument("--costs", help="JSON of events/s and init seconds per job; read if present, written after calibrating")
+    parser.add_argument("--calibrate", type=int, default=100, help="events per calibration run")
+    parser.add_argument("--granularity", type=float, default=2.0, help="shards per worker share of the work")
+    parser.add_argument("--dry-run", action="store_true", help="print the plan without running it")
+    args = parser.parse_args()
+
+    try:
+        jobs = [Job(spec) for spec in args.jobs]
+    except ValueError as error:
+        print(f"Error: {error}")
+        return 1
+    os.makedirs(args.out_dir, exist_ok=True)
+
+    costs = {}
+    if args.costs and os.path.exists(args.costs):
+        with open(args.costs) as f:
+            costs = json.load(f)
+    for job in jobs:
+        if job.key in costs:
+            job.rate = costs[job.key]["events_per_s"]
+            job.init_seconds = costs[job.key]["init_s"]
+        else:
+            calibrate(job, args.bin_dir, args.out_dir, args.calibrate, args.seed)
+            costs[job.key] = {"events_per_s": job.rate, "init_s": job.init_seconds}
+    if args.costs:
+        with open(args.costs, "w") as f:
+            json.dump(costs, f, indent=2)
+
+    sets = cpu_sets(args.numa)
+    n_workers = args.workers or len(sets)
+    sets = [sets[w % len(sets)] for w in range(n_workers)]
+    shards = make_shards(jobs, n_workers, args.granularity)
+    queues, loads = assign(shards, n_workers)
+
+    print(f"Run seed {args.seed}, {len(shards)} shards on {n_workers} workers")
+    for w, queue in enumerate(queues):
+        names = ", ".join(f"{s['job'].name}[{s['first']}:{s['last']}]" for s in queue)
+        print(f"Worker {w} (cpus {sorted(sets[w])}): estimated {loads[w]:.0f} s: {names}")
+    if args.dry_run:
+        return 0
+
+    stats = [None] * n_workers
+    start = time.time()
+    threads = [threading.Thread(target=run_worker, args=(w, sets[w], queues[w], args, stats)) for w in range(n_workers)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    wall = time.time() - start
+
+    merge(jobs, shards, args.out_dir)
+
+    print("Worker  Shards  Estimated  Finished  CPU s  Utilization")
+    for w, stat in enumerate(stats):
+        print(f"{w}  {stat['shards']}  {loads[w]:.0f}  {stat['finished']:.0f}  {stat['cpu']:.0f}  "
+              f"{stat['cpu'] / (wall * len(sets[w])) if wall > 0 else 0:.1%}")
+    cpu_total = sum(stat["cpu"] for stat in stats)
+    cores = sum(len(cpus) for cpus in sets)
+    finish = [stat["finished"] for stat in stats]
+    print(f"Wall {wall:.0f} s, first worker done at {min(finish):.0f} s, "
+          f"utilization {cpu_total / (wall * cores) if wall > 0 else 0:.1%} of {cores} cores")
+    return 0 if all(s.get("ok") for s in shards) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
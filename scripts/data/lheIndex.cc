@@ -0,0 +1,30 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include "lheIndex.h"
+
+// Writes the <file>.idx event-offset sidecar for each LHE file given, for use with
+// training_smeft100 --events begin:end (see lheIndex.h and lheSlice.h).
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <LHE_file> [<LHE_file> ...]" << std::endl;
+        return 1;
+    }
+
+    int nFailed = 0;
+    for (int a = 1; a < argc; a++) {
+        const std::string lheFile = argv[a];
+        auto start = std::chrono::steady_clock::now();
+        LheIndex index;
+        if (!buildLheIndex(lheFile, index) || !writeLheIndex(lheFile, index)) {
+            nFailed++;
+            continue;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << lheFile << ": " << index.size() << " events indexed in " << seconds << " s ("
+                  << index.fileSize / 1e6 / std::max(seconds, 1e-9) << " MB/s) -> " << lheIndexPath(lheFile) << std::endl;
+    }
+    return nFailed > 0 ? 1 : 0;
+}
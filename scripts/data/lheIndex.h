@@ -0,0 +1,146 @@
+#ifndef LHE_INDEX_H
+#define LHE_INDEX_H
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Byte offsets of the <init> block and of every <event> block of a Les Houches event file,
+// so an event range can be served without reading the file front to back (see lheSlice.h).
+//
+// Sidecar <file>.idx (little endian):
+//   0    char[8]   magic "LHEIDX01"
+//   8    uint64    size of the LHE file when indexed, to detect stale sidecars
+//   16   uint64    offset of "<init"
+//   24   uint64    nEvents
+//   32   uint64    offsets[nEvents] of "<event"
+struct LheIndex {
+    uint64_t fileSize = 0;
+    uint64_t initOffset = 0;
+    std::vector<uint64_t> events;
+
+    long size() const { return static_cast<long>(events.size()); }
+};
+
+inline std::string lheIndexPath(const std::string& lheFile) {
+    return lheFile + ".idx";
+}
+
+inline uint64_t lheFileSize(const std::string& path) {
+    struct stat info;
+    return (stat(path.c_str(), &info) == 0) ? static_cast<uint64_t>(info.st_size) : 0;
+}
+
+// True if buf[p] starts the tag <name followed by '>' or whitespace; needs len - p > name length + 1
+inline bool isLheTag(const char* buf, size_t p, const char* name, size_t nameLength) {
+    if (std::memcmp(buf + p + 1, name, nameLength) != 0) return false;
+    char next = buf[p + 1 + nameLength];
+    return next == '>' || std::isspace(static_cast<unsigned char>(next));
+}
+
+// Single pass over the file in large chunks, jumping between '<' characters with memchr.
+// Event tags are only accepted after <init>, so nothing in the header can be mistaken for one.
+inline bool buildLheIndex(const std::string& path, LheIndex& index) {
+    index = LheIndex();
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Error: Could not open LHE file: " << path << std::endl;
+        return false;
+    }
+
+    const size_t kChunk = 4 << 20;
+    const size_t kTail = 6; // Longest tag checked is "<event" + delimiter, 7 bytes
+    std::vector<char> buf(kChunk + kTail);
+    uint64_t base = 0; // File offset of buf[0]
+    size_t carry = 0;
+    bool inBody = false;
+    size_t n;
+    while ((n = std::fread(buf.data() + carry, 1, kChunk, file)) > 0) {
+        const size_t len = carry + n;
+        const char* data = buf.data();
+        size_t p = 0;
+        while (p + kTail < len) {
+            const void* hit = std::memchr(data + p, '<', len - kTail - p);
+            if (!hit) break;
+            p = static_cast<const char*>(hit) - data;
+            if (inBody) {
+                if (isLheTag(data, p, "event", 5)) index.events.push_back(base + p);
+            } else if (isLheTag(data, p, "init", 4)) {
+                index.initOffset = base + p;
+                inBody = true;
+            }
+            p++;
+        }
+        // Keep the unchecked tail for the next chunk
+        if (len <= kTail) break;
+        std::memmove(buf.data(), buf.data() + len - kTail, kTail);
+        base += len - kTail;
+        carry = kTail;
+    }
+    std::fclose(file);
+
+    if (!inBody) {
+        std::cerr << "Error: No <init> block in " << path << std::endl;
+        return false;
+    }
+    index.fileSize = lheFileSize(path);
+    return true;
+}
+
+// Written to a temporary name and renamed, so concurrent writers never leave a torn sidecar
+inline bool writeLheIndex(const std::string& lheFile, const LheIndex& index) {
+    const std::string path = lheIndexPath(lheFile);
+    const std::string tmp = path + ".tmp" + std::to_string(getpid());
+    FILE* file = std::fopen(tmp.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Error: Could not write LHE index: " << path << std::endl;
+        return false;
+    }
+    const uint64_t header[3] = {index.fileSize, index.initOffset, static_cast<uint64_t>(index.events.size())};
+    bool ok = std::fwrite("LHEIDX01", 1, 8, file) == 8 &&
+              std::fwrite(header, sizeof(uint64_t), 3, file) == 3 &&
+              std::fwrite(index.events.data(), sizeof(uint64_t), index.events.size(), file) == index.events.size();
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        std::cerr << "Error: Could not write LHE index: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Reads the sidecar; false if it is missing or was built from a file of a different size
+inline bool readLheIndex(const std::string& lheFile, LheIndex& index) {
+    index = LheIndex();
+    FILE* file = std::fopen(lheIndexPath(lheFile).c_str(), "rb");
+    if (!file) return false;
+    char magic[8];
+    uint64_t header[3];
+    bool ok = std::fread(magic, 1, 8, file) == 8 && std::memcmp(magic, "LHEIDX01", 8) == 0 &&
+              std::fread(header, sizeof(uint64_t), 3, file) == 3 && header[0] == lheFileSize(lheFile);
+    if (ok) {
+        index.fileSize = header[0];
+        index.initOffset = header[1];
+        index.events.resize(header[2]);
+        ok = std::fread(index.events.data(), sizeof(uint64_t), header[2], file) == header[2];
+    }
+    std::fclose(file);
+    if (!ok) index = LheIndex();
+    return ok;
+}
+
+// Sidecar if it is current, otherwise index the file and (best effort) save the sidecar
+inline bool loadLheIndex(const std::string& lheFile, LheIndex& index) {
+    if (readLheIndex(lheFile, index)) return true;
+    if (!buildLheIndex(lheFile, index)) return false;
+    writeLheIndex(lheFile, index);
+    return true;
+}
+
+#endif
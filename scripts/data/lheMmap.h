@@ -0,0 +1,302 @@
+#ifndef LHE_MMAP_H
+#define LHE_MMAP_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Pythia8/Pythia.h"
+#include "lheIndex.h"
+
+// Zero-copy Les Houches input: the file is mmap'ed and <init>/<event> blocks are parsed in
+// place by the number scanners below, with no iostreams, no per-line strings and no heap
+// traffic per event. LHAupMmap serves the whole file front to back or, given the .idx index
+// (lheIndex.h), the event slice [begin, end). Used with Beams:frameType = 5 and setLHAupPtr().
+
+namespace lhe {
+
+// Read-only private mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const std::string& path, bool sequential) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+        base = static_cast<const char*>(mapped);
+        length = static_cast<size_t>(info.st_size);
+        // Front-to-back reads benefit from aggressive readahead; slices jump around
+        madvise(mapped, length, sequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+        return true;
+    }
+
+    void close() {
+        if (base) munmap(const_cast<char*>(base), length);
+        base = nullptr;
+        length = 0;
+    }
+
+    const char* begin() const { return base; }
+    const char* end() const { return base + length; }
+    size_t size() const { return length; }
+
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+};
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline const char* skipSpace(const char* p, const char* end) {
+    while (p < end && isSpace(*p)) p++;
+    return p;
+}
+
+inline const char* nextLine(const char* p, const char* end) {
+    const void* newline = std::memchr(p, '\n', end - p);
+    return newline ? static_cast<const char*>(newline) + 1 : end;
+}
+
+inline const char* find(const char* p, const char* end, const char* needle, size_t needleLength) {
+    const void* hit = memmem(p, end - p, needle, needleLength);
+    return hit ? static_cast<const char*>(hit) : end;
+}
+
+inline bool parseInt(const char*& p, const char* end, int& out) {
+    p = skipSpace(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+    if (p == end || *p < '0' || *p > '9') return false;
+    long value = 0;
+    while (p < end && *p >= '0' && *p <= '9') value = value * 10 + (*p++ - '0');
+    out = static_cast<int>(negative ? -value : value);
+    return true;
+}
+
+// Decimal or scientific (e/E, Fortran d/D) notation. Mantissas of up to 19 digits that fit in
+// 53 bits with a decimal exponent within +-22 are converted exactly with one multiply or divide
+// by a power of ten, which covers everything MadGraph writes; anything else goes to strtod.
+inline bool parseDouble(const char*& p, const char* end, double& out) {
+    static const double kPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    p = skipSpace(p, end);
+    const char* start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any = false;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa) digits++;
+        } else {
+            exponent++;
+            digits++;
+        }
+        any = true;
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa) digits++;
+                exponent--;
+            } else {
+                digits++;
+            }
+            any = true;
+            p++;
+        }
+    }
+    if (!any) return false;
+    if (p < end && (*p == 'e' || *p == 'E' || *p == 'd' || *p == 'D')) {
+        const char* q = p + 1;
+        int power = 0;
+        if (parseInt(q, end, power)) {
+            exponent += power;
+            p = q;
+        }
+    }
+
+    if (digits <= 19 && mantissa < (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+        double value = static_cast<double>(mantissa);
+        value = (exponent < 0) ? value / kPow10[-exponent] : value * kPow10[exponent];
+        out = negative ? -value : value;
+        return true;
+    }
+
+    // Slow path on a terminated copy, since the mapping is not null-terminated
+    char token[64];
+    size_t n = std::min(static_cast<size_t>(p - start), sizeof(token) - 1);
+    std::memcpy(token, start, n);
+    token[n] = '\0';
+    for (size_t k = 0; k < n; k++) {
+        if (token[k] == 'd' || token[k] == 'D') token[k] = 'e';
+    }
+    out = std::strtod(token, nullptr);
+    return true;
+}
+
+}
+
+class LHAupMmap : public Pythia8::LHAup {
+public:
+    // Whole file, read front to back
+    explicit LHAupMmap(const std::string& path) : path(path) {
+        open(true);
+    }
+
+    // Events [begin, end) of an indexed file
+    LHAupMmap(const std::string& path, const LheIndex& index, long begin, long end)
+        : path(path), offsets(index.events.begin() + std::min(std::max(begin, 0L), index.size()),
+                              index.events.begin() + std::min(std::max(end, std::max(begin, 0L)), index.size())) {
+        indexed = true;
+        open(false);
+    }
+
+    bool setInit() override {
+        if (!file.size()) return false;
+        const char* p = file.begin();
+        const char* end = file.end();
+
+        const char* init = lhe::find(p, end, "<init", 5);
+        const char* slhaBegin = lhe::find(p, init, "<slha>", 6);
+        const char* slhaEnd = lhe::find(slhaBegin, init, "</slha>", 7);
+        if (slhaBegin != init && slhaEnd != init) {
+            setInfoHeader("slha", std::string(slhaBegin + 6, slhaEnd));
+        }
+        if (init == end) {
+            std::cerr << "Error: No <init> block in " << path << std::endl;
+            return false;
+        }
+
+        p = lhe::nextLine(init, end);
+        int idA, idB, pdfGroupA, pdfGroupB, pdfSetA, pdfSetB, strategy, nProcesses;
+        double eA, eB;
+        if (!(lhe::parseInt(p, end, idA) && lhe::parseInt(p, end, idB) && lhe::parseDouble(p, end, eA) &&
+              lhe::parseDouble(p, end, eB) && lhe::parseInt(p, end, pdfGroupA) && lhe::parseInt(p, end, pdfGroupB) &&
+              lhe::parseInt(p, end, pdfSetA) && lhe::parseInt(p, end, pdfSetB) && lhe::parseInt(p, end, strategy) &&
+              lhe::parseInt(p, end, nProcesses))) {
+            std::cerr << "Error: Malformed <init> block in " << path << std::endl;
+            return false;
+        }
+        setBeamA(idA, eA, pdfGroupA, pdfSetA);
+        setBeamB(idB, eB, pdfGroupB, pdfSetB);
+        setStrategy(strategy);
+        eBeamA = eA;
+        eBeamB = eB;
+
+        for (int k = 0; k < nProcesses; k++) {
+            double xSec, xErr, xMax;
+            int code;
+            if (!(lhe::parseDouble(p, end, xSec) && lhe::parseDouble(p, end, xErr) &&
+                  lhe::parseDouble(p, end, xMax) && lhe::parseInt(p, end, code))) return false;
+            addProcess(code, xSec, xErr, xMax);
+        }
+        cursor = lhe::find(p, end, "</init>", 7);
+        return true;
+    }
+
+    // False at the end of the file or slice, which Pythia reports as end of file
+    bool setEvent(int = 0) override {
+        const char* end = file.end();
+        const char* block;
+        if (indexed) {
+            if (next >= offsets.size()) return false;
+            block = file.begin() + offsets[next++];
+        } else {
+            block = lhe::find(cursor, end, "<event", 6);
+            if (block == end) return false;
+        }
+
+        const char* p = lhe::nextLine(block, end);
+        int nParticles, code;
+        double weight, scale, alphaQED, alphaQCD;
+        if (!(lhe::parseInt(p, end, nParticles) && lhe::parseInt(p, end, code) && lhe::parseDouble(p, end, weight) &&
+              lhe::parseDouble(p, end, scale) && lhe::parseDouble(p, end, alphaQED) &&
+              lhe::parseDouble(p, end, alphaQCD))) {
+            std::cerr << "Error: Malformed <event> block at byte " << (block - file.begin()) << " of " << path << std::endl;
+            return false;
+        }
+        setProcess(code, weight, scale, alphaQED, alphaQCD);
+
+        // Incoming partons give the momentum fractions unless a #pdf line overrides them
+        int id1 = 0, id2 = 0;
+        double x1 = 0, x2 = 0;
+        for (int i = 0; i < nParticles; i++) {
+            int fields[6];
+            double values[7];
+            for (int& field : fields) {
+                if (!lhe::parseInt(p, end, field)) return false;
+            }
+            for (double& value : values) {
+                if (!lhe::parseDouble(p, end, value)) return false;
+            }
+            addParticle(fields[0], fields[1], fields[2], fields[3], fields[4], fields[5],
+                        values[0], values[1], values[2], values[3], values[4], values[5], values[6]);
+            if (fields[1] == -1 && id1 == 0) {
+                id1 = fields[0];
+                x1 = values[3] / eBeamA;
+            } else if (fields[1] == -1 && id2 == 0) {
+                id2 = fields[0];
+                x2 = values[3] / eBeamB;
+            }
+        }
+
+        const char* blockEnd = lhe::find(p, end, "</event>", 8);
+        const char* pdf = lhe::find(p, blockEnd, "#pdf", 4);
+        if (pdf != blockEnd) {
+            pdf += 4;
+            lhe::parseInt(pdf, blockEnd, id1);
+            lhe::parseInt(pdf, blockEnd, id2);
+            lhe::parseDouble(pdf, blockEnd, x1);
+            lhe::parseDouble(pdf, blockEnd, x2);
+        }
+        setIdX(id1, id2, x1, x2);
+        cursor = blockEnd;
+        return true;
+    }
+
+private:
+    void open(bool sequential) {
+        if (!file.open(path, sequential)) {
+            std::cerr << "Error: Could not map LHE file: " << path << std::endl;
+        }
+        cursor = file.begin();
+    }
+
+    std::string path;
+    lhe::MappedFile file;
+    std::vector<uint64_t> offsets;
+    bool indexed = false;
+    size_t next = 0;
+    const char* cursor = nullptr;
+    double eBeamA = 1, eBeamB = 1;
+};
+
+#endif
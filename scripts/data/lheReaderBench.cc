@@ -0,0 +1,134 @@
+#include <iostream>
+#include <cmath>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include "Pythia8/Pythia.h"
+#include "lheMmap.h"
+
+using namespace Pythia8;
+
+// Compares LHE ingestion through Pythia's LHEF reader (Beams:frameType = 4) with LHAupMmap
+// (lheMmap.h) on one of our samples:
+//   1. the raw LHAupMmap parse rate, without Pythia;
+//   2. ingestion-only event rates of both readers (parton and hadron level off);
+//   3. the process records of both readers, event by event, which must agree;
+//   4. the full training shower rate, to show what share of a run ingestion costs.
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Pythia reading the file but doing nothing else with the events
+void configureIngestOnly(Pythia& pythia) {
+    pythia.readString("Print:quiet = on");
+    pythia.readString("ProcessLevel:resonanceDecays = off");
+    pythia.readString("PartonLevel:all = off");
+    pythia.readString("HadronLevel:all = off");
+    pythia.readString("Check:event = off");
+}
+
+void useReader(Pythia& pythia, const std::string& lheFile, bool mmapReader) {
+    if (mmapReader) {
+        pythia.readString("Beams:frameType = 5");
+        pythia.setLHAupPtr(std::make_shared<LHAupMmap>(lheFile));
+    } else {
+        pythia.readString("Beams:frameType = 4");
+        pythia.readString("Beams:LHEF = " + lheFile);
+    }
+}
+
+// Events per second until end of file (or nMax events)
+double eventRate(Pythia& pythia, long nMax, long& nEvents) {
+    auto start = std::chrono::steady_clock::now();
+    nEvents = 0;
+    while (nEvents < nMax) {
+        if (!pythia.next()) {
+            if (pythia.info.atEndOfFile()) break;
+            continue;
+        }
+        nEvents++;
+    }
+    return nEvents / std::max(secondsSince(start), 1e-9);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <LHE_file> [nShowerEvents = 200]" << std::endl;
+        return 1;
+    }
+    const std::string lheFile = argv[1];
+    const long nShower = (argc > 2) ? std::stol(argv[2]) : 200;
+    const long kAll = 1L << 40;
+
+    // 1. Raw parse
+    double parseRate;
+    long nParsed = 0;
+    {
+        auto start = std::chrono::steady_clock::now();
+        LHAupMmap reader(lheFile);
+        if (!reader.setInit()) return 1;
+        while (reader.setEvent()) nParsed++;
+        parseRate = nParsed / std::max(secondsSince(start), 1e-9);
+    }
+    std::cout << "LHAupMmap parse only:     " << nParsed << " events, " << parseRate << " events/s" << std::endl;
+
+    // 2. Ingestion through Pythia
+    double ingestRate[2];
+    for (int mmapReader = 0; mmapReader < 2; mmapReader++) {
+        Pythia pythia;
+        configureIngestOnly(pythia);
+        useReader(pythia, lheFile, mmapReader);
+        if (!pythia.init()) return 1;
+        long n;
+        ingestRate[mmapReader] = eventRate(pythia, kAll, n);
+        std::cout << (mmapReader ? "Pythia + LHAupMmap:       " : "Pythia + LHEF (type 4):   ") << n << " events, "
+                  << ingestRate[mmapReader] << " events/s" << std::endl;
+    }
+
+    // 3. Both readers must hand Pythia the same process records
+    long nCompared = 0, nMismatch = 0;
+    {
+        Pythia stock, mapped;
+        configureIngestOnly(stock);
+        configureIngestOnly(mapped);
+        useReader(stock, lheFile, false);
+        useReader(mapped, lheFile, true);
+        if (!stock.init() || !mapped.init()) return 1;
+        while (stock.next() && mapped.next()) {
+            nCompared++;
+            bool same = stock.process.size() == mapped.process.size() && stock.info.code() == mapped.info.code();
+            for (int k = 0; same && k < stock.process.size(); k++) {
+                const Particle& a = stock.process[k];
+                const Particle& b = mapped.process[k];
+                double scale = std::max(1.0, std::abs(a.e()));
+                same = a.id() == b.id() && a.status() == b.status() && a.mother1() == b.mother1() &&
+                       std::abs(a.px() - b.px()) < 1e-12 * scale && std::abs(a.py() - b.py()) < 1e-12 * scale &&
+                       std::abs(a.pz() - b.pz()) < 1e-12 * scale && std::abs(a.e() - b.e()) < 1e-12 * scale;
+            }
+            if (!same) nMismatch++;
+        }
+    }
+    std::cout << "Process records compared: " << nCompared << ", mismatches: " << nMismatch << std::endl;
+
+    // 4. Showering, with the training_smeft100 settings
+    double showerRate;
+    {
+        Pythia pythia;
+        pythia.readString("Print:quiet = on");
+        pythia.readString("Beams:eCM = 100.e3");
+        pythia.readString("25:onMode = on");
+        useReader(pythia, lheFile, true);
+        if (!pythia.init()) return 1;
+        long n;
+        showerRate = eventRate(pythia, nShower, n);
+        std::cout << "Full shower:              " << n << " events, " << showerRate << " events/s" << std::endl;
+    }
+
+    for (int mmapReader = 0; mmapReader < 2; mmapReader++) {
+        std::cout << (mmapReader ? "Ingestion share, mmap:    " : "Ingestion share, LHEF:    ")
+                  << 100.0 * showerRate / ingestRate[mmapReader] << " % of shower time" << std::endl;
+    }
+    return nMismatch > 0 ? 1 : 0;
+}
@@ -0,0 +1,142 @@
+#ifndef LHE_SLICE_H
+#define LHE_SLICE_H
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Pythia8/Pythia.h"
+#include "lheIndex.h"
+
+// Les Houches reader serving events [begin, end) of an indexed LHE file, so several Pythia
+// instances can shower disjoint slices of one sample in parallel. Used with Beams:frameType = 5
+// and pythia.setLHAupPtr(). setInit() parses the <init> block (and hands the <slha> header
+// block to Pythia like the LHEF reader does); setEvent() seeks to the next indexed <event>.
+class LHAupSlice : public Pythia8::LHAup {
+public:
+    LHAupSlice(const std::string& path, const LheIndex& index, long begin, long end)
+        : in(path), header(headerText(path, index.initOffset)), initOffset(index.initOffset),
+          offsets(index.events.begin() + clamp(begin, 0, index.size()),
+                  index.events.begin() + clamp(end, clamp(begin, 0, index.size()), index.size())) {
+        if (!in.is_open()) std::cerr << "Error: Could not open LHE file: " << path << std::endl;
+    }
+
+    bool setInit() override {
+        if (!in.is_open()) return false;
+        size_t slhaBegin = header.find("<slha>"), slhaEnd = header.find("</slha>");
+        if (slhaBegin != std::string::npos && slhaEnd != std::string::npos && slhaEnd > slhaBegin) {
+            setInfoHeader("slha", header.substr(slhaBegin + 6, slhaEnd - slhaBegin - 6));
+        }
+
+        in.seekg(static_cast<std::streamoff>(initOffset));
+        std::string line;
+        if (!std::getline(in, line) || !nextDataLine(line)) return false;
+        std::istringstream beams(line);
+        int idA, idB, pdfGroupA, pdfGroupB, pdfSetA, pdfSetB, strategy, nProcesses;
+        double eA, eB;
+        if (!(beams >> idA >> idB >> eA >> eB >> pdfGroupA >> pdfGroupB >> pdfSetA >> pdfSetB >> strategy >> nProcesses)) {
+            std::cerr << "Error: Malformed <init> block" << std::endl;
+            return false;
+        }
+        setBeamA(idA, eA, pdfGroupA, pdfSetA);
+        setBeamB(idB, eB, pdfGroupB, pdfSetB);
+        setStrategy(strategy);
+        eBeamA = eA;
+        eBeamB = eB;
+
+        for (int p = 0; p < nProcesses; p++) {
+            if (!nextDataLine(line)) return false;
+            std::istringstream process(line);
+            double xSec, xErr, xMax;
+            int code;
+            if (!(process >> xSec >> xErr >> xMax >> code)) return false;
+            addProcess(code, xSec, xErr, xMax);
+        }
+        return true;
+    }
+
+    // False once the slice is exhausted, which Pythia reports as end of file
+    bool setEvent(int = 0) override {
+        if (next >= offsets.size()) return false;
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(offsets[next++]));
+
+        std::string line;
+        if (!std::getline(in, line) || !nextDataLine(line)) return false;
+        std::istringstream process(line);
+        int nParticles, code;
+        double weight, scale, alphaQED, alphaQCD;
+        if (!(process >> nParticles >> code >> weight >> scale >> alphaQED >> alphaQCD)) return false;
+        setProcess(code, weight, scale, alphaQED, alphaQCD);
+
+        // Incoming partons give the momentum fractions unless a #pdf line overrides them
+        int id1 = 0, id2 = 0;
+        double x1 = 0, x2 = 0;
+        for (int i = 0; i < nParticles; i++) {
+            if (!std::getline(in, line)) return false;
+            const char* cursor = line.c_str();
+            char* end = nullptr;
+            int fields[6];
+            for (int& field : fields) {
+                field = static_cast<int>(std::strtol(cursor, &end, 10));
+                cursor = end;
+            }
+            double values[7];
+            for (double& value : values) {
+                value = std::strtod(cursor, &end);
+                cursor = end;
+            }
+            addParticle(fields[0], fields[1], fields[2], fields[3], fields[4], fields[5],
+                        values[0], values[1], values[2], values[3], values[4], values[5], values[6]);
+            if (fields[1] == -1 && id1 == 0) {
+                id1 = fields[0];
+                x1 = values[3] / eBeamA;
+            } else if (fields[1] == -1 && id2 == 0) {
+                id2 = fields[0];
+                x2 = values[3] / eBeamB;
+            }
+        }
+        while (std::getline(in, line) && line.find("</event>") == std::string::npos) {
+            if (line.compare(0, 4, "#pdf") == 0) {
+                std::istringstream pdf(line.substr(4));
+                pdf >> id1 >> id2 >> x1 >> x2;
+            }
+        }
+        setIdX(id1, id2, x1, x2);
+        return true;
+    }
+
+    long size() const { return static_cast<long>(offsets.size()); }
+
+private:
+    static long clamp(long k, long lo, long hi) {
+        return (k < lo) ? lo : (k > hi ? hi : k);
+    }
+
+    static std::string headerText(const std::string& path, uint64_t length) {
+        std::ifstream file(path, std::ios::binary);
+        std::string text(length, '\0');
+        file.read(&text[0], static_cast<std::streamsize>(length));
+        return text;
+    }
+
+    // Advance to the next non-empty line that is not a comment or tag
+    bool nextDataLine(std::string& line) {
+        while (std::getline(in, line)) {
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first != std::string::npos && line[first] != '#' && line[first] != '<') return true;
+        }
+        return false;
+    }
+
+    std::ifstream in;
+    std::string header;
+    uint64_t initOffset;
+    std::vector<uint64_t> offsets;
+    size_t next = 0;
+    double eBeamA = 1, eBeamB = 1;
+};
+
+#endif
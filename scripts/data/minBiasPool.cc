@@ -0,0 +1,79 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include "Pythia8/Pythia.h"
+#include "eventCache.h"
+#include "eventSeeds.h"
+#include "pileupOverlay.h"
+
+using namespace Pythia8;
+
+// Writes the minimum-bias pool read by --pileup (pileupOverlay.h): inelastic pp events
+// (SoftQCD:inelastic) at one collision energy, final-state particles only, in the event cache
+// format. Generated once per energy and reused by every signal run; event i is seeded from
+// (seed, i) like the signal generators, so a pool can be extended or regenerated exactly.
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <pool_cache> <TeV> <nEvents> [--seed <n>]" << std::endl;
+        return 1;
+    }
+    const std::string poolFile = argv[1];
+    char* end = nullptr;
+    const double tev = std::strtod(argv[2], &end);
+    if (*end != '\0' || tev <= 0) {
+        std::cerr << "Error: Bad collision energy '" << argv[2] << "' (TeV)" << std::endl;
+        return 1;
+    }
+    const long nEvents = std::strtol(argv[3], &end, 10);
+    if (*end != '\0' || nEvents <= 0) {
+        std::cerr << "Error: Bad event count '" << argv[3] << "'" << std::endl;
+        return 1;
+    }
+    uint64_t runSeed = 20240601;
+    for (int a = 4; a < argc; a++) {
+        std::string arg = argv[a];
+        if (arg == "--seed" && a + 1 < argc) {
+            runSeed = std::strtoull(argv[++a], nullptr, 10);
+        } else {
+            std::cerr << "Error: Unknown argument '" << arg << "'" << std::endl;
+            return 1;
+        }
+    }
+
+    // Proton-proton inelastic (non-diffractive + diffractive) collisions
+    Pythia pythia;
+    pythia.readString("Beams:idA = 2212");
+    pythia.readString("Beams:idB = 2212");
+    pythia.readString("Beams:eCM = " + std::to_string(tev * 1e3));
+    pythia.readString("SoftQCD:inelastic = on");
+    pythia.readString("Next:numberCount = 0");
+    pythia.readString("Random:setSeed = on");
+    pythia.readString("Random:seed = " + std::to_string(seeds::eventSeed(runSeed, seeds::kInitCounter)));
+    if (!pythia.init()) {
+        std::cerr << "Error: Pythia initialization failed" << std::endl;
+        return 1;
+    }
+
+    evcache::Writer pool;
+    if (!pool.open(poolFile)) return 1;
+    EventSnapshot snap, reduced;
+    long nParticles = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < nEvents; i++) {
+        pythia.rndm.init(seeds::eventSeed(runSeed, i));
+        if (!pythia.next()) continue;
+        snap.fill(pythia.event, pythia.info.code());
+        snap.eventIndex = i;
+        pileup::keepFinalState(snap, reduced);
+        if (!pool.write(reduced)) return 1;
+        nParticles += reduced.size();
+    }
+    if (!pool.close()) return 1;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Minimum-bias pool: " << pool.events() << " events at " << tev << " TeV, "
+              << (pool.events() > 0 ? double(nParticles) / pool.events() : 0.0) << " final-state particles per event, "
+              << seconds << " s -> " << poolFile << std::endl;
+    return 0;
+}
@@ -0,0 +1,125 @@
+#ifndef OUTPUT_SCHEMA_H
+#define OUTPUT_SCHEMA_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Output rows described as a compile-time list of column extractors. Schema<Columns...> expands
+// to straight-line code per generator: the CSV header, the CSV row and the packed float32 row
+// (ring / .npy) all come from the same list, with no string comparisons or virtual calls.
+//
+// A column is a struct with
+//   static void header(std::ostream&, const Context&)   CSV header name(s)
+//   static void csv(std::ostream&, const Row&)          CSV field(s), no leading separator
+//   static constexpr size_t binaryWidth                 floats in the binary row (0 = CSV only)
+//   static void binary(const Row&, float*)              fill binaryWidth floats
+//   static void binaryNames(std::vector<std::string>&)  names of those floats
+// Column<Derived> supplies the header from Derived::name and an empty binary part.
+namespace schema {
+
+template <class Derived>
+struct Column {
+    static constexpr size_t binaryWidth = 0;
+
+    template <class Context>
+    static void header(std::ostream& out, const Context&) { out << Derived::name; }
+
+    template <class Row>
+    static void binary(const Row&, float*) {}
+
+    static void binaryNames(std::vector<std::string>&) {}
+};
+
+// One float per row under the column name
+template <class Derived>
+struct ScalarColumn : Column<Derived> {
+    static constexpr size_t binaryWidth = 1;
+
+    template <class Row>
+    static void binary(const Row& row, float* out) { out[0] = static_cast<float>(Derived::value(row)); }
+
+    static void binaryNames(std::vector<std::string>& names) { names.push_back(Derived::name); }
+
+    template <class Row>
+    static void csv(std::ostream& out, const Row& row) { out << Derived::value(row); }
+};
+
+template <class... Columns>
+struct Schema {
+    static constexpr size_t binaryWidth = (Columns::binaryWidth + ... + 0);
+
+    template <class Context>
+    static void writeHeader(std::ostream& out, const Context& context, const char* separator = ",") {
+        bool first = true;
+        ((out << (first ? "" : separator), first = false, Columns::header(out, context)), ...);
+        out << "\n";
+    }
+
+    template <class Row>
+    static void writeCsv(std::ostream& out, const Row& row) {
+        bool first = true;
+        ((out << (first ? "" : ","), first = false, Columns::csv(out, row)), ...);
+        out << "\n";
+    }
+
+    template <class Row>
+    static void writeBinary(const Row& row, float* out) {
+        size_t offset = 0;
+        ((Columns::binary(row, out + offset), offset += Columns::binaryWidth), ...);
+    }
+
+    static std::vector<std::string> binaryNames() {
+        std::vector<std::string> names;
+        (Columns::binaryNames(names), ...);
+        return names;
+    }
+};
+
+// Columns shared by the generators. Rows provide decayIds (std::vector<int>), invMass and, for
+// the Higgs generators, processCode and eventIndex.
+
+// Decay product ids joined by ';'; the binary row holds the first two
+struct DecayProducts : Column<DecayProducts> {
+    static constexpr const char* name = "DecayProducts";
+    static constexpr size_t binaryWidth = 2;
+
+    template <class Row>
+    static void csv(std::ostream& out, const Row& row) {
+        for (size_t d = 0; d < row.decayIds.size(); d++) {
+            out << row.decayIds[d];
+            if (d < row.decayIds.size() - 1) out << ";";
+        }
+    }
+
+    template <class Row>
+    static void binary(const Row& row, float* out) {
+        out[0] = static_cast<float>(row.decayIds[0]);
+        out[1] = static_cast<float>(row.decayIds[1]);
+    }
+
+    static void binaryNames(std::vector<std::string>& names) {
+        names.push_back("DecayProduct1");
+        names.push_back("DecayProduct2");
+    }
+};
+
+struct InvMasses : ScalarColumn<InvMasses> {
+    static constexpr const char* name = "InvMasses";
+    template <class Row> static double value(const Row& row) { return row.invMass; }
+};
+
+struct ProductionChannel : ScalarColumn<ProductionChannel> {
+    static constexpr const char* name = "ProductionChannel";
+    template <class Row> static int value(const Row& row) { return row.processCode; }
+};
+
+struct EventIndex : ScalarColumn<EventIndex> {
+    static constexpr const char* name = "EventIndex";
+    template <class Row> static long value(const Row& row) { return row.eventIndex; }
+};
+
+}
+
+#endif
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Pythia8/Pythia.h"
+#include "fastjet/ClusterSequence.hh"
+#include "higgsGenerator.h"
+
+// Analysis throughput under pileup: signal events from an event cache (written with --cache)
+// are held in memory, then for each <mu> overlaid from a minimum-bias pool (minBiasPool) and
+// run through the Higgs jet analysis, once with plain clustering and once with area-based
+// subtraction. Rows go nowhere; only overlay + analysis time is measured.
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <signal_cache> <pool_cache> [--mu <mu>[,<mu>...]] [--events <n>]"
+                  << " [--jets alg:R[:ptmin],...]" << std::endl;
+        return 1;
+    }
+    const std::string signalFile = argv[1], poolFile = argv[2];
+    std::vector<double> mus = {0., 50., 200., 1000.};
+    long maxEvents = 200;
+    std::vector<JetConfig> jetConfigs = {JetConfig()};
+    for (int a = 3; a < argc; a++) {
+        std::string arg = argv[a];
+        if (arg == "--mu" && a + 1 < argc) {
+            mus.clear();
+            std::stringstream list(argv[++a]);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                char* end = nullptr;
+                double mu = std::strtod(item.c_str(), &end);
+                if (item.empty() || *end != '\0' || mu < 0) {
+                    std::cerr << "Error: Bad pileup mean '" << item << "'" << std::endl;
+                    return 1;
+                }
+                mus.push_back(mu);
+            }
+        } else if (arg == "--events" && a + 1 < argc) {
+            maxEvents = std::strtol(argv[++a], nullptr, 10);
+        } else if (arg == "--jets" && a + 1 < argc) {
+            if (!parseJetConfigs(argv[++a], jetConfigs)) return 1;
+        } else {
+            std::cerr << "Error: Unknown argument '" << arg << "'" << std::endl;
+            return 1;
+        }
+    }
+
+    evcache::Reader cache;
+    if (!cache.open(signalFile)) return 1;
+    std::vector<EventSnapshot> signal;
+    EventSnapshot snap;
+    while (static_cast<long>(signal.size()) < maxEvents && cache.next(snap)) signal.push_back(snap);
+    pileup::Pool pool;
+    if (signal.empty() || !pool.load(poolFile)) {
+        std::cerr << "Error: Need signal events and a minimum-bias pool" << std::endl;
+        return 1;
+    }
+    std::cout << signal.size() << " signal events, pool of " << pool.events() << " minimum-bias events ("
+              << double(pool.particles()) / pool.events() << " particles each)" << std::endl;
+
+    std::ostream sink(nullptr);
+    for (double mu : mus) {
+        for (bool subtract : {false, true}) {
+            pileup::Config config;
+            config.poolFile = poolFile;
+            config.mu = mu;
+            config.subtract = subtract;
+            pileup::Overlay overlay(pool, config);
+            HiggsJetAnalysis analysis(jetConfigs, JetMatching::Trace, detector::Config(), subtract);
+            HardCandidates<HiggsIds> higgs;
+
+            long nInputs = 0;
+            int nCandidates = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (const EventSnapshot& event : signal) {
+                snap = event;
+                overlay.apply(snap, snap.eventIndex);
+                nInputs += static_cast<long>(snap.finalState.size());
+                nCandidates += analyzeHiggsEvent(snap, higgs, analysis, sink);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "mu " << mu << (subtract ? ", area-subtracted: " : ", unsubtracted:    ")
+                      << double(nInputs) / signal.size() << " final-state particles/event, " << nCandidates
+                      << " candidates, " << (seconds > 0 ? signal.size() / seconds : 0.0) << " events/s" << std::endl;
+        }
+    }
+    return 0;
+}
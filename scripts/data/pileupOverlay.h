@@ -0,0 +1,151 @@
+#ifndef PILEUP_OVERLAY_H
+#define PILEUP_OVERLAY_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "eventSnapshot.h"
+#include "eventCache.h"
+#include "eventSeeds.h"
+
+// Pileup from a pre-generated minimum-bias pool (--pileup <pool>:<mu>). The pool is an event
+// cache of final-state-only minimum-bias events, written once per collision energy by
+// minBiasPool.cc, and loaded whole into flat arrays shared read-only by every worker.
+// Each signal event gets Poisson(mu) pool events, drawn with replacement, appended to its
+// snapshot as extra final-state entries without ancestry: everything downstream (detector
+// response, clustering) sees them, while decay-product tracing never reaches them. The draws
+// of an event come from its own stream seeded with (seed, event index), as for the signal.
+// Area-based subtraction of the resulting offset is done per jet definition in
+// HiggsJetAnalysis (ClusterSequenceArea, GridMedianBackgroundEstimator, Subtractor).
+// A pool of N events reused at <mu> per signal event repeats each pool event about
+// nSignal * mu / N times; keep N well above mu so overlaid events are uncorrelated.
+namespace pileup {
+
+struct Config {
+    std::string poolFile; // Empty = no pileup
+    double mu = 0.0;      // Mean number of pileup interactions per signal event
+    bool subtract = true; // Area-based subtraction in the jet clustering
+    uint64_t seed = 20240601;
+
+    bool enabled() const { return !poolFile.empty(); }
+};
+
+// "<pool_cache>:<mu>[:nosub]"
+inline bool parsePileupConfig(const std::string& spec, Config& config) {
+    config = Config();
+    std::string rest = spec;
+    if (rest.size() > 6 && rest.compare(rest.size() - 6, 6, ":nosub") == 0) {
+        config.subtract = false;
+        rest.resize(rest.size() - 6);
+    }
+    size_t colon = rest.rfind(':');
+    if (colon == std::string::npos || colon == 0) return false;
+    char* end = nullptr;
+    config.mu = std::strtod(rest.c_str() + colon + 1, &end);
+    if (*end != '\0' || config.mu < 0) return false;
+    config.poolFile = rest.substr(0, colon);
+    return true;
+}
+
+// Pool entry of a generated minimum-bias event: its final-state particles only, without ancestry
+inline void keepFinalState(const EventSnapshot& event, EventSnapshot& reduced) {
+    reduced.clear();
+    for (int k : event.finalState) {
+        reduced.px.push_back(event.px[k]);
+        reduced.py.push_back(event.py[k]);
+        reduced.pz.push_back(event.pz[k]);
+        reduced.e.push_back(event.e[k]);
+        reduced.id.push_back(event.id[k]);
+        reduced.status.push_back(1);
+        reduced.mother1.push_back(0);
+        reduced.mother2.push_back(0);
+        reduced.daughter1.push_back(0);
+        reduced.daughter2.push_back(0);
+        reduced.finalState.push_back(reduced.size() - 1);
+    }
+    reduced.processCode = event.processCode;
+    reduced.eventIndex = event.eventIndex;
+}
+
+// Final-state particles of every pool event, in flat arrays
+class Pool {
+public:
+    bool load(const std::string& path) {
+        evcache::Reader reader;
+        if (!reader.open(path)) return false;
+        EventSnapshot snap;
+        offsets.assign(1, 0);
+        while (reader.next(snap)) {
+            for (int k : snap.finalState) {
+                px.push_back(static_cast<float>(snap.px[k]));
+                py.push_back(static_cast<float>(snap.py[k]));
+                pz.push_back(static_cast<float>(snap.pz[k]));
+                e.push_back(static_cast<float>(snap.e[k]));
+                id.push_back(snap.id[k]);
+            }
+            offsets.push_back(static_cast<uint32_t>(id.size()));
+        }
+        if (events() == 0) {
+            std::cerr << "Error: Pileup pool " << path << " holds no events" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    long events() const { return offsets.empty() ? 0 : static_cast<long>(offsets.size()) - 1; }
+    long particles() const { return static_cast<long>(id.size()); }
+
+    std::vector<float> px, py, pz, e;
+    std::vector<int> id;
+    std::vector<uint32_t> offsets; // Event n holds particles offsets[n]..offsets[n + 1]
+};
+
+// Per-worker overlay onto signal snapshots; does nothing without a pileup configuration
+class Overlay {
+public:
+    Overlay(const Pool& poolIn, const Config& configIn) : pool(poolIn), config(configIn) {}
+
+    // Append Poisson(mu) pool events to snap; returns how many were added
+    int apply(EventSnapshot& snap, long eventKey) {
+        if (!config.enabled() || pool.events() == 0) return 0;
+        std::mt19937_64 rng(seeds::splitmix64(config.seed ^ seeds::splitmix64(static_cast<uint64_t>(eventKey))));
+        std::uniform_int_distribution<long> pick(0, pool.events() - 1);
+        // A fresh distribution per event: libstdc++ draws large means through a normal distribution
+        // that caches its second value, which would tie the count to the events drawn before
+        const int nPileup = (config.mu > 0) ? std::poisson_distribution<int>(config.mu)(rng) : 0;
+        for (int n = 0; n < nPileup; n++) {
+            const long event = pick(rng);
+            for (uint32_t p = pool.offsets[event]; p < pool.offsets[event + 1]; p++) {
+                const int k = snap.size();
+                snap.px.push_back(pool.px[p]);
+                snap.py.push_back(pool.py[p]);
+                snap.pz.push_back(pool.pz[p]);
+                snap.e.push_back(pool.e[p]);
+                snap.id.push_back(pool.id[p]);
+                snap.status.push_back(1);
+                snap.mother1.push_back(0);
+                snap.mother2.push_back(0);
+                snap.daughter1.push_back(0);
+                snap.daughter2.push_back(0);
+                snap.finalState.push_back(k);
+            }
+        }
+        nEvents++;
+        nOverlaid += nPileup;
+        return nPileup;
+    }
+
+    double meanOverlaid() const { return nEvents > 0 ? double(nOverlaid) / nEvents : 0.0; }
+
+private:
+    const Pool& pool;
+    Config config;
+    long nEvents = 0, nOverlaid = 0;
+};
+
+} // namespace pileup
+
+#endif
@@ -0,0 +1,365 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <csignal>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Local result service: runs a generator on request and streams its CSV rows to the client as
+// they are written, instead of sending a finished file at the end of the run.
+//
+//   resultServer [--port <n> | --unix <socket>] -- <generator> <args...>
+//
+// "{out}" in the generator arguments is replaced by /dev/fd/3, a pipe the service reads; e.g.
+//   resultServer --port 8090 -- ./build/release/tevmain 13:25000:{out}
+//   resultServer --unix /tmp/hsas.sock -- ./build/release/training_smeft100 run.lhe {out}
+// The generator's own stdout/stderr go to the service's.
+//
+// Endpoints (HTTP/1.1 on 127.0.0.1 or the Unix socket):
+//   GET /generate[?seed=<n>&nevents=<n>]  start a run (one at a time, 503 while busy) and stream
+//                                         its CSV as chunked transfer encoding, one chunk per batch
+//                                         of complete rows; seed / nevents become --seed / --nevents
+//                                         (Higgs generators; training_smeft100 takes neither)
+//   GET /progress                         JSON: running, rows and bytes so far, elapsed seconds, exit code
+//   GET /throughput                       JSON: rows/s and MB/s over the run and the last few seconds
+// Rows are forwarded from a fixed 64 KiB buffer; a slow client fills the pipe and stalls the
+// generator rather than growing server memory.
+
+namespace {
+
+const size_t kBufferBytes = 64 * 1024;
+const double kWindowSeconds = 5.0;
+
+using Clock = std::chrono::steady_clock;
+
+double secondsBetween(Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration<double>(b - a).count();
+}
+
+// State of the current (or last) run, read by /progress and /throughput while /generate streams
+struct RunState {
+    std::atomic<bool> running{false};
+    std::atomic<long> rows{0}, bytes{0};
+    std::atomic<int> exitCode{-1};
+
+    std::mutex mutex; // Guards the fields below
+    Clock::time_point start, end;
+    std::deque<std::pair<Clock::time_point, long>> window; // (time, rows) samples of the last seconds
+
+    void begin() {
+        std::lock_guard<std::mutex> lock(mutex);
+        rows = 0;
+        bytes = 0;
+        exitCode = -1;
+        start = end = Clock::now();
+        window.clear();
+        window.emplace_back(start, 0);
+    }
+
+    void addRows(long n, long nBytes) {
+        rows += n;
+        bytes += nBytes;
+        std::lock_guard<std::mutex> lock(mutex);
+        Clock::time_point now = Clock::now();
+        window.emplace_back(now, rows.load());
+        while (window.size() > 2 && secondsBetween(window.front().first, now) > kWindowSeconds) window.pop_front();
+    }
+
+    void finish(int code) {
+        std::lock_guard<std::mutex> lock(mutex);
+        end = Clock::now();
+        exitCode = code;
+        running = false;
+    }
+
+    double elapsed() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return secondsBetween(start, running ? Clock::now() : end);
+    }
+
+    double recentRowRate() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (window.size() < 2) return 0;
+        double seconds = secondsBetween(window.front().first, running ? Clock::now() : window.back().first);
+        return seconds > 0 ? (window.back().second - window.front().second) / seconds : 0;
+    }
+};
+
+RunState state;
+std::vector<std::string> generatorCommand;
+
+bool sendAll(int fd, const char* data, size_t n) {
+    while (n > 0) {
+        ssize_t sent = send(fd, data, n, MSG_NOSIGNAL);
+        if (sent <= 0) return false;
+        data += sent;
+        n -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool sendChunk(int fd, const char* data, size_t n) {
+    char size[32];
+    int length = std::snprintf(size, sizeof(size), "%zx\r\n", n);
+    return sendAll(fd, size, length) && sendAll(fd, data, n) && sendAll(fd, "\r\n", 2);
+}
+
+void sendResponse(int fd, const std::string& status, const std::string& type, const std::string& body) {
+    std::ostringstream head;
+    head << "HTTP/1.1 " << status << "\r\nContent-Type: " << type << "\r\nContent-Length: " << body.size()
+         << "\r\nConnection: close\r\n\r\n";
+    std::string response = head.str() + body;
+    sendAll(fd, response.data(), response.size());
+}
+
+// Value of key in a query string "a=1&b=2", empty if absent
+std::string queryValue(const std::string& query, const std::string& key) {
+    std::stringstream items(query);
+    std::string item;
+    while (std::getline(items, item, '&')) {
+        size_t eq = item.find('=');
+        if (eq != std::string::npos && item.substr(0, eq) == key) return item.substr(eq + 1);
+    }
+    return "";
+}
+
+bool isCount(const std::string& text) {
+    return !text.empty() && text.size() < 20 && std::all_of(text.begin(), text.end(), ::isdigit);
+}
+
+// fork/exec the generator with its CSV output on the write end of a pipe as fd 3. Other client
+// threads may hold the malloc lock at fork time, so the child only makes async-signal-safe calls:
+// argv is built beforehand
+pid_t spawnGenerator(const std::vector<std::string>& args, int& readFd) {
+    std::vector<char*> argv;
+    for (const std::string& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+    int pipeFds[2];
+    if (pipe2(pipeFds, O_CLOEXEC) != 0) return -1;
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(pipeFds[1], 3); // dup2 clears close-on-exec on fd 3 only
+        if (pipeFds[0] != 3) close(pipeFds[0]);
+        if (pipeFds[1] != 3) close(pipeFds[1]);
+        execvp(argv[0], argv.data());
+        static const char message[] = "Error: Could not start generator\n";
+        ssize_t ignored = write(STDERR_FILENO, message, sizeof(message) - 1);
+        (void)ignored;
+        _exit(127);
+    }
+    close(pipeFds[1]);
+    if (pid < 0) {
+        close(pipeFds[0]);
+        return -1;
+    }
+    readFd = pipeFds[0];
+    return pid;
+}
+
+void streamRun(int client, const std::string& query) {
+    bool idle = false;
+    if (!state.running.compare_exchange_strong(idle, true)) {
+        sendResponse(client, "503 Service Unavailable", "text/plain", "A run is already in progress\n");
+        return;
+    }
+    std::vector<std::string> args;
+    for (const std::string& arg : generatorCommand) {
+        std::string expanded = arg;
+        size_t at = expanded.find("{out}");
+        if (at != std::string::npos) expanded.replace(at, 5, "/dev/fd/3");
+        args.push_back(expanded);
+    }
+    for (const char* key : {"seed", "nevents"}) {
+        std::string value = queryValue(query, key);
+        if (value.empty()) continue;
+        if (!isCount(value)) {
+            state.running = false;
+            sendResponse(client, "400 Bad Request", "text/plain", std::string("Bad ") + key + "\n");
+            return;
+        }
+        args.push_back(std::string("--") + key);
+        args.push_back(value);
+    }
+
+    state.begin();
+    int pipeFd = -1;
+    pid_t pid = spawnGenerator(args, pipeFd);
+    if (pid < 0) {
+        state.finish(-1);
+        sendResponse(client, "500 Internal Server Error", "text/plain", "Could not start the generator\n");
+        return;
+    }
+    std::cout << "Run started: pid " << pid << std::endl;
+
+    const char* head = "HTTP/1.1 200 OK\r\nContent-Type: text/csv\r\nTransfer-Encoding: chunked\r\n"
+                       "Cache-Control: no-cache\r\nConnection: close\r\n\r\n";
+    bool clientOk = sendAll(client, head, std::strlen(head));
+
+    // Forward complete lines as they arrive; a partial last line waits for the next read
+    std::vector<char> buffer(kBufferBytes);
+    size_t filled = 0;
+    bool header = true;
+    while (clientOk) {
+        if (filled == buffer.size()) buffer.resize(buffer.size() * 2); // Only for a line longer than the buffer
+        ssize_t n = read(pipeFd, buffer.data() + filled, buffer.size() - filled);
+        if (n <= 0) break;
+        size_t begin = filled;
+        filled += static_cast<size_t>(n);
+        const char* lastNewline = static_cast<const char*>(memrchr(buffer.data() + begin, '\n', n));
+        if (!lastNewline) continue;
+        size_t complete = static_cast<size_t>(lastNewline - buffer.data()) + 1;
+        long lines = std::count(buffer.data() + begin, buffer.data() + complete, '\n');
+        if (header && lines > 0) {
+            lines--;
+            header = false;
+        }
+        clientOk = sendChunk(client, buffer.data(), complete);
+        state.addRows(lines, static_cast<long>(complete));
+        std::memmove(buffer.data(), buffer.data() + complete, filled - complete);
+        filled -= complete;
+        if (buffer.size() > kBufferBytes && filled < kBufferBytes) buffer.resize(kBufferBytes);
+    }
+    if (clientOk && filled > 0) clientOk = sendChunk(client, buffer.data(), filled);
+    if (clientOk) sendAll(client, "0\r\n\r\n", 5);
+
+    // A client that went away stops the run
+    if (!clientOk) kill(pid, SIGTERM);
+    close(pipeFd);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    int code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    state.finish(code);
+    std::cout << "Run finished: " << state.rows << " rows, exit code " << code
+              << (clientOk ? "" : " (client disconnected)") << std::endl;
+}
+
+std::string progressJson() {
+    std::ostringstream json;
+    json << "{\"running\": " << (state.running ? "true" : "false") << ", \"rows\": " << state.rows
+         << ", \"bytes\": " << state.bytes << ", \"elapsed_s\": " << state.elapsed()
+         << ", \"exit_code\": " << state.exitCode << "}\n";
+    return json.str();
+}
+
+std::string throughputJson() {
+    double elapsed = state.elapsed();
+    std::ostringstream json;
+    json << "{\"rows_per_s\": " << (elapsed > 0 ? state.rows / elapsed : 0.0)
+         << ", \"recent_rows_per_s\": " << state.recentRowRate()
+         << ", \"mb_per_s\": " << (elapsed > 0 ? state.bytes / 1e6 / elapsed : 0.0)
+         << ", \"window_s\": " << kWindowSeconds << "}\n";
+    return json.str();
+}
+
+void handleClient(int client) {
+    // Request line and headers; the body of a GET is ignored
+    std::string request;
+    char chunk[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 16384) {
+        ssize_t n = recv(client, chunk, sizeof(chunk), 0);
+        if (n <= 0) break;
+        request.append(chunk, static_cast<size_t>(n));
+    }
+    std::istringstream line(request.substr(0, request.find("\r\n")));
+    std::string method, target;
+    line >> method >> target;
+    size_t question = target.find('?');
+    std::string path = target.substr(0, question);
+    std::string query = (question == std::string::npos) ? "" : target.substr(question + 1);
+
+    if (method != "GET") {
+        sendResponse(client, "405 Method Not Allowed", "text/plain", "Only GET is supported\n");
+    } else if (path == "/generate") {
+        streamRun(client, query);
+    } else if (path == "/progress") {
+        sendResponse(client, "200 OK", "application/json", progressJson());
+    } else if (path == "/throughput") {
+        sendResponse(client, "200 OK", "application/json", throughputJson());
+    } else {
+        sendResponse(client, "404 Not Found", "text/plain", "Endpoints: /generate, /progress, /throughput\n");
+    }
+    close(client);
+}
+
+int listenOn(int port, const std::string& unixPath) {
+    int fd;
+    if (!unixPath.empty()) {
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (unixPath.size() >= sizeof(address.sun_path)) return -1;
+        std::strcpy(address.sun_path, unixPath.c_str());
+        unlink(unixPath.c_str());
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) return -1;
+    } else {
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Local clients only
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) return -1;
+    }
+    return listen(fd, 16) == 0 ? fd : -1;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int port = 8090;
+    std::string unixPath;
+    int a = 1;
+    for (; a < argc; a++) {
+        std::string arg = argv[a];
+        if (arg == "--port" && a + 1 < argc) {
+            port = std::atoi(argv[++a]);
+        } else if (arg == "--unix" && a + 1 < argc) {
+            unixPath = argv[++a];
+        } else if (arg == "--") {
+            a++;
+            break;
+        } else {
+            a = argc + 1;
+        }
+    }
+    for (; a < argc; a++) generatorCommand.push_back(argv[a]);
+    if (generatorCommand.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--port <n> | --unix <socket>] -- <generator> <args with {out}...>"
+                  << std::endl;
+        return 1;
+    }
+
+    int server = listenOn(port, unixPath);
+    if (server < 0) {
+        std::cerr << "Error: Could not listen on " << (unixPath.empty() ? "127.0.0.1:" + std::to_string(port) : unixPath)
+                  << std::endl;
+        return 1;
+    }
+    std::cout << "Result service on " << (unixPath.empty() ? "http://127.0.0.1:" + std::to_string(port) : unixPath)
+              << " running:";
+    for (const std::string& arg : generatorCommand) std::cout << " " << arg;
+    std::cout << std::endl;
+
+    while (true) {
+        // Close-on-exec, so a generator started for one client never holds another connection open
+        int client = accept4(server, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) continue;
+        std::thread(handleClient, client).detach();
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fork-join pool with persistent helper threads. run(n, task) calls task(i) for every
+// i in [0, n) across the helpers and the calling thread and returns once all calls are done.
+// The task is passed by reference through a plain function pointer, so a run() performs no
+// heap allocation; with zero helpers it is a plain loop on the caller.
+class TaskPool {
+public:
+    explicit TaskPool(int nHelpers) {
+        for (int t = 0; t < nHelpers; t++) helpers.emplace_back([this] { helperLoop(); });
+    }
+
+    ~TaskPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& helper : helpers) helper.join();
+    }
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    // Helpers worth starting for nTasks independent tasks on this machine
+    static int helpersFor(int nTasks) {
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+        return std::max(0, std::min(nTasks, std::max(cores, 1)) - 1);
+    }
+
+    template <class Task>
+    void run(int n, Task& task) {
+        if (helpers.empty()) {
+            for (int i = 0; i < n; i++) task(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            fn = [](void* ctx, int i) { (*static_cast<Task*>(ctx))(i); };
+            ctx = &task;
+            nTasks = n;
+            next = 0;
+            active = static_cast<int>(helpers.size());
+            generation++;
+        }
+        wake.notify_all();
+        work();
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return active == 0; });
+    }
+
+private:
+    void work() {
+        for (int i = next.fetch_add(1); i < nTasks; i = next.fetch_add(1)) fn(ctx, i);
+    }
+
+    void helperLoop() {
+        unsigned long seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            work();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--active == 0) done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> helpers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    void (*fn)(void*, int) = nullptr;
+    void* ctx = nullptr;
+    int nTasks = 0;
+    std::atomic<int> next{0};
+    int active = 0;
+    unsigned long generation = 0;
+    bool stopping = false;
+};
+
+#endif
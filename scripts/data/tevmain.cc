@@ -0,0 +1,139 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include "Pythia8/Pythia.h"
+#include "fastjet/ClusterSequence.hh"
+#include "higgsGenerator.h"
+
+using namespace Pythia8;
+using namespace fastjet;
+
+// SM Higgs production (ggH, VBF, VH, ttH) at one or more collision energies in one process,
+// replacing the former 13/30/60/100tevmain binaries. The settings and particle data are read
+// from the XML database once into a template Pythia; every energy gets a Pythia constructed
+// from the template's Settings and ParticleData, so only the beam energy and the per-energy
+// initialization (PDFs, cross-section maxima) are redone. Energies run one after another and
+// each Pythia is destroyed before the next is built, so peak memory is that of a single run.
+
+// One energy of the scan and where its rows go
+struct ScanPoint {
+    double eCM;       // GeV
+    long nEvents;
+    std::string outputFile;
+    std::string label; // As given on the command line, e.g. "13"
+};
+
+// "<TeV>:<events>:<output_file>[,<TeV>:<events>:<output_file>...]"
+bool parseScan(const std::string& text, std::vector<ScanPoint>& points) {
+    std::stringstream items(text);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        size_t first = item.find(':');
+        size_t second = (first == std::string::npos) ? std::string::npos : item.find(':', first + 1);
+        if (second == std::string::npos || second + 1 >= item.size()) return false;
+        ScanPoint point;
+        point.label = item.substr(0, first);
+        char* end = nullptr;
+        double tev = std::strtod(point.label.c_str(), &end);
+        if (end == point.label.c_str() || *end != '\0' || tev <= 0) return false;
+        std::string events = item.substr(first + 1, second - first - 1);
+        point.nEvents = std::strtol(events.c_str(), &end, 10);
+        if (end == events.c_str() || *end != '\0' || point.nEvents < 0) return false;
+        point.eCM = tev * 1e3;
+        point.outputFile = item.substr(second + 1);
+        points.push_back(point);
+    }
+    return !points.empty();
+}
+
+int main(int argc, char* argv[]) {
+    // The <output_file> slot of the shared generator options holds the scan list
+    GeneratorOptions options;
+    if (!parseGeneratorOptions(argc, argv, options)) {
+        std::cerr << "  <output_file> here is a scan list <TeV>:<events>:<output_file>[,...],"
+                  << " e.g. 13:25000:higgs13.csv,100:25000:higgs100.csv" << std::endl;
+        return 1;
+    }
+    std::vector<ScanPoint> points;
+    if (!parseScan(options.outputFile, points)) {
+        std::cerr << "Error: Bad scan list '" << options.outputFile << "' (use <TeV>:<events>:<output_file>,...)"
+                  << std::endl;
+        return 1;
+    }
+
+    // Analysis-only rerun from an event cache, without Pythia
+    if (!options.replayFile.empty()) {
+        if (points.size() != 1) {
+            std::cerr << "Error: --replay takes a single <TeV>:<events>:<output_file> entry" << std::endl;
+            return 1;
+        }
+        std::ofstream outFile(points[0].outputFile);
+        if (!outFile.is_open()) {
+            std::cerr << "Error: Could not open file for writing: " << points[0].outputFile << std::endl;
+            return 1;
+        }
+        return replayHiggsEvents(options, outFile);
+    }
+
+    // Template with proton-proton collisions + enabled main Higgs processes, never initialized
+    Pythia base;
+    base.readString("Beams:idA = 2212");
+    base.readString("Beams:idB = 2212");
+    base.readString("HiggsSM:all  = off");
+    base.readString("HiggsSM:gg2H = on"); // Enable gg -> H (ggH)
+    base.readString("HiggsSM:ff2Hff(t:ZZ) = on"); // Enable VBF (VBF: quark initiated)
+    base.readString("HiggsSM:ff2Hff(t:W+W-) = on"); // Enable VBF (quark initiated)
+    base.readString("HiggsSM:ffbar2Hffbar(t:ZZ) = on"); // Enable VH production (associated with Z)
+    base.readString("HiggsSM:ffbar2Hffbar(t:W+W-) = on"); // Enable VH production (associated with W)
+    base.readString("HiggsSM:qqbar2Httbar = on"); // Enable ttH production
+    base.readString("25:onMode = on");
+
+    const uint64_t scanSeed = options.runSeed;
+    for (size_t p = 0; p < points.size(); p++) {
+        const ScanPoint& point = points[p];
+        std::ofstream outFile(point.outputFile);
+        if (!outFile.is_open()) {
+            std::cerr << "Error: Could not open file for writing: " << point.outputFile << std::endl;
+            return 1;
+        }
+
+        // Independent streams per energy; the printed run seed reproduces this energy alone
+        GeneratorOptions pointOptions = options;
+        pointOptions.runSeed = (points.size() > 1) ? seeds::splitmix64(scanSeed + p) : scanSeed;
+        pointOptions.nEvents = (options.nEvents >= 0) ? options.nEvents : point.nEvents; // --nevents overrides
+        if (!options.cacheFile.empty() && points.size() > 1) {
+            pointOptions.cacheFile = options.cacheFile + "." + point.label + "tev";
+        }
+
+        std::cout << "Energy " << point.label << " TeV -> " << point.outputFile << std::endl;
+        Pythia pythia(base.settings, base.particleData, false);
+        applyRunSeed(pythia, pointOptions);
+        pythia.readString("Beams:eCM = " + std::to_string(point.eCM));
+        if (!pointOptions.quotas.empty()) {
+            // Per-channel quotas run as weighted single-process sub-runs at this energy; the
+            // entry's event count is replaced by the quotas
+            if (runQuotaEvents(pythia, pointOptions, point.outputFile, outFile) != 0) return 1;
+            continue;
+        }
+        if (!pythia.init()) {
+            std::cerr << "Error: Pythia initialization failed at " << point.label << " TeV" << std::endl;
+            return 1;
+        }
+
+        std::cout << "Checkpoint: Pythia initialized." << std::endl;
+
+        // Jet definitions from --jets, anti-kt with R = 0.4 by default
+        if (!runHiggsEvents(pythia, static_cast<int>(pointOptions.nEvents), pointOptions, outFile)) return 1;
+
+        outFile.close();
+        std::cout << "Checkpoint: Output file closed." << std::endl;
+    }
+
+    //Finished
+    std::cout << "Checkpoint: Scan over " << points.size() << " energies completed." << std::endl;
+    return alloccount::exitStatus(0);
+}
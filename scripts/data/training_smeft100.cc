@@ -1,120 +1,597 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <cmath>
 #include <vector>
 #include <algorithm>
 #include <map>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <limits>
+#include <memory>
+#include <sys/stat.h>
 #include "Pythia8/Pythia.h"
 #include "fastjet/ClusterSequence.hh"
+#include "eventSnapshot.h"
+#include "kinematicsKernels.h"
+#include "allocCounter.h"
+#include "featureRing.h"
+#include "featureMatrix.h"
+#include "lheIndex.h"
+#include "lheSlice.h"
+#include "lheMmap.h"
+#include "eventCache.h"
+#include "outputSchema.h"
+#include "hardCandidates.h"
+#include "detectorResponse.h"
 
 using namespace Pythia8;
 using namespace fastjet;
 
-double invariantMass(const std::vector<Vec4>& momenta) {
-    Vec4 total;
-    for (const auto& p : momenta) {
-        total += p;
+double invariantMass(const kin::MomentumBatch& momenta) {
+    return kin::sumBatch(momenta).mCalc();
+}
+
+// One Higgs candidate of the output
+struct TrainingRow {
+    int higgsId = 0;
+    std::vector<int> decayIds;
+    double invMass = 0, pT = 0, rapidity = 0;
+    int jetMultiplicity = 0;
+};
+
+struct HiggsBoson : schema::ScalarColumn<HiggsBoson> {
+    static constexpr const char* name = "HiggsBoson";
+    static int value(const TrainingRow& row) { return row.higgsId; }
+};
+
+struct HiggsPt : schema::ScalarColumn<HiggsPt> {
+    static constexpr const char* name = "pT";
+    static double value(const TrainingRow& row) { return row.pT; }
+};
+
+struct HiggsRapidity : schema::ScalarColumn<HiggsRapidity> {
+    static constexpr const char* name = "Rapidity";
+    static double value(const TrainingRow& row) { return row.rapidity; }
+};
+
+struct JetMultiplicity : schema::ScalarColumn<JetMultiplicity> {
+    static constexpr const char* name = "JetMultiplicity";
+    static int value(const TrainingRow& row) { return row.jetMultiplicity; }
+};
+
+// CSV columns, and the float32 features (ring / .npy) in the order the Keras model expects them
+using TrainingSchema = schema::Schema<HiggsBoson, schema::DecayProducts, schema::InvMasses, HiggsPt, HiggsRapidity,
+                                      JetMultiplicity>;
+const int nFeatures = static_cast<int>(TrainingSchema::binaryWidth);
+const std::vector<std::string> featureNames = TrainingSchema::binaryNames();
+
+// Showered events per whole-file LHE run; an event slice runs to its end
+const long nEventsPerRun = 10000;
+
+// One LHE file and the outputs produced from it
+struct TrainingRun {
+    std::string lheFile;
+    std::string outputFile;
+    std::string npyFile;          // Also write the float32 feature matrix here if set
+    std::string coefficientsFile; // Wilson coefficients of this run (wilson_coefficients.json)
+    std::string cacheFile;        // Also store the showered events in this event cache (eventCache.h)
+    long eventBegin = 0;          // Event slice [eventBegin, eventEnd) of the LHE file, read
+    long eventEnd = -1;           // through its index; -1 = whole file
+
+    bool sliced() const { return eventEnd >= 0; }
+};
+
+struct TrainingOptions {
+    TrainingRun run;
+    std::string shmName;      // Publish feature batches to this shared-memory ring if set
+    std::string manifestFile; // Batch mode: one run per manifest line
+    int nWorkers = 0;         // Batch mode worker count, 0 = one per core
+    bool mmapReader = false;  // Read LHE input through LHAupMmap instead of Pythia's LHEF reader
+    std::string replayFile;   // Rerun the analysis over this event cache instead of showering
+    detector::Config detector; // Detector response before clustering; disabled by default
+};
+
+// Run-level labels, stored once rather than per row (CSV first line, .npy metadata, ring header)
+struct RunCoefficients {
+    std::vector<double> values;
+    std::string source = "none"; // json, lhe or none
+};
+
+// Events, candidates and wall time of one run, summed per worker in batch mode
+struct RunStats {
+    long events = 0;
+    long candidates = 0;
+    double seconds = 0;
+};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <LHE_file> <output_file> [--shm <name>] [--npy <file.npy>]"
+              << " [--coefficients <json>] [--events <begin>:<end>] [--reader lhef|mmap] [--detector <spec>]" << std::endl;
+    std::cerr << "       " << program << " --manifest <file> [--workers <n>] [--reader lhef|mmap]" << std::endl;
+    std::cerr << "       " << program << " --replay <cache> <output_file> [--shm <name>] [--npy <file.npy>]"
+              << " [--coefficients <json>]" << std::endl;
+    std::cerr << "  --shm           also stream feature rows to the shared-memory ring <name> (see featureRing.h)" << std::endl;
+    std::cerr << "  --npy           also write the float32 feature matrix as .npy, with run metadata in"
+              << " <file.npy>.meta.json" << std::endl;
+    std::cerr << "  --coefficients  Wilson coefficients of the run (default: the BLOCK SMEFT of the LHE header), stored"
+              << " once in the CSV's first line, the metadata and the ring labels" << std::endl;
+    std::cerr << "  --events        shower only LHE events [begin, end) via the <LHE_file>.idx index (see lheIndex.cc);"
+              << " end may be omitted" << std::endl;
+    std::cerr << "  --reader        LHE input through Pythia's LHEF reader (default) or the zero-copy mmap reader"
+              << " (lheMmap.h, see lheReaderBench.cc)" << std::endl;
+    std::cerr << "  --cache         also store the showered event records in a compressed event cache" << std::endl;
+    std::cerr << "  --replay        run the analysis over an event cache written with --cache, without Pythia" << std::endl;
+    std::cerr << "  --detector      acceptance, invisible removal and smearing before clustering (detectorResponse.h),"
+              << " e.g. generic or generic,towers=0.1" << std::endl;
+    std::cerr << "  --manifest      process many runs, one per line:" << std::endl;
+    std::cerr << "                  <LHE_file> <output_file> [<file.npy>|- [<json>|- [<begin>:<end>]]]" << std::endl;
+    std::cerr << "  --workers       worker threads for --manifest, each with its own Pythia (default: one per core)" << std::endl;
+}
+
+// "begin:end" or "begin:" (to the end of the file)
+bool parseEventRange(const std::string& text, TrainingRun& run) {
+    size_t colon = text.find(':');
+    if (colon == std::string::npos || colon == 0) return false;
+    char* end = nullptr;
+    run.eventBegin = std::strtol(text.c_str(), &end, 10);
+    if (end != text.c_str() + colon || run.eventBegin < 0) return false;
+    if (colon + 1 == text.size()) {
+        run.eventEnd = std::numeric_limits<long>::max();
+        return true;
     }
-    return total.mCalc();
+    run.eventEnd = std::strtol(text.c_str() + colon + 1, &end, 10);
+    return *end == '\0' && run.eventEnd >= run.eventBegin;
 }
 
-int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <LHE_file> <output_file>" << std::endl;
-        return 1;
+bool parseOptions(int argc, char* argv[], TrainingOptions& options) {
+    std::vector<std::string> positional;
+    for (int a = 1; a < argc; a++) {
+        std::string arg = argv[a];
+        if (arg == "--shm" && a + 1 < argc) {
+            options.shmName = argv[++a];
+        } else if (arg == "--npy" && a + 1 < argc) {
+            options.run.npyFile = argv[++a];
+        } else if (arg == "--coefficients" && a + 1 < argc) {
+            options.run.coefficientsFile = argv[++a];
+        } else if (arg == "--events" && a + 1 < argc) {
+            if (!parseEventRange(argv[++a], options.run)) return false;
+        } else if (arg == "--manifest" && a + 1 < argc) {
+            options.manifestFile = argv[++a];
+        } else if (arg == "--cache" && a + 1 < argc) {
+            options.run.cacheFile = argv[++a];
+        } else if (arg == "--replay" && a + 1 < argc) {
+            options.replayFile = argv[++a];
+        } else if (arg == "--reader" && a + 1 < argc) {
+            std::string reader = argv[++a];
+            if (reader != "lhef" && reader != "mmap") return false;
+            options.mmapReader = (reader == "mmap");
+        } else if (arg == "--detector" && a + 1 < argc) {
+            if (!detector::parseDetectorConfig(argv[++a], options.detector)) return false;
+        } else if (arg == "--workers" && a + 1 < argc) {
+            options.nWorkers = std::atoi(argv[++a]);
+        } else if (arg.rfind("--", 0) != 0) {
+            positional.push_back(arg);
+        } else {
+            return false;
+        }
     }
-    std::ifstream inFile(argv[1]);
-    if (!inFile.is_open()) {
-        std::cerr << "Error: Could not open LHE file: " << argv[1] << std::endl;
-        return 1;
+    if (!options.manifestFile.empty()) {
+        // The ring has a single consumer, so it only makes sense for a single run
+        return positional.empty() && options.shmName.empty() && options.run.cacheFile.empty();
     }
+    if (!options.replayFile.empty()) {
+        if (positional.size() != 1 || options.run.sliced() || !options.run.cacheFile.empty()) return false;
+        options.run.outputFile = positional[0];
+        return true;
+    }
+    if (positional.size() != 2) return false;
+    options.run.lheFile = positional[0];
+    options.run.outputFile = positional[1];
+    return true;
+}
 
-    std::ofstream outFile(argv[2]);
-    if (!outFile.is_open()) {
-        std::cerr << "Error: Could not open outfile for writing: " << argv[2] << std::endl;
-        return 1;
+// Manifest lines: <LHE_file> <output_file> [<file.npy>|- [<coefficients_json>|- [<begin>:<end>]]];
+// blank lines and # comments skipped
+bool readManifest(const std::string& path, std::vector<TrainingRun>& runs) {
+    std::ifstream manifest(path);
+    if (!manifest.is_open()) {
+        std::cerr << "Error: Could not open manifest: " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(manifest, line)) {
+        lineNumber++;
+        std::istringstream fields(line);
+        TrainingRun run;
+        if (!(fields >> run.lheFile) || run.lheFile[0] == '#') continue;
+        if (!(fields >> run.outputFile)) {
+            std::cerr << "Error: " << path << ":" << lineNumber << ": expected <LHE_file> <output_file>" << std::endl;
+            return false;
+        }
+        std::string events;
+        fields >> run.npyFile >> run.coefficientsFile >> events;
+        if (run.npyFile == "-") run.npyFile.clear();
+        if (run.coefficientsFile == "-") run.coefficientsFile.clear();
+        if (!events.empty() && !parseEventRange(events, run)) {
+            std::cerr << "Error: " << path << ":" << lineNumber << ": bad event range '" << events << "'" << std::endl;
+            return false;
+        }
+        runs.push_back(run);
     }
+    return true;
+}
 
-    // Initialize Pythia with MadGraph LHE file
-    Pythia pythia;
-    std::cout << std::string(argv[1]) << std::endl;
+long fileSize(const std::string& path) {
+    struct stat info;
+    return (stat(path.c_str(), &info) == 0) ? static_cast<long>(info.st_size) : 0;
+}
+
+// The coefficient JSON if given, else the BLOCK SMEFT of the LHE header, else none
+bool resolveCoefficients(const TrainingRun& run, RunCoefficients& coefficients) {
+    coefficients = RunCoefficients();
+    if (!run.coefficientsFile.empty()) {
+        if (!readCoefficientsJson(run.coefficientsFile, coefficients.values)) return false;
+        coefficients.source = "json";
+    } else if (readLheSmeftBlock(run.lheFile, coefficients.values)) {
+        coefficients.source = "lhe";
+    }
+    return true;
+}
+
+// Events to shower for the run: the slice length (clipped to the file), else nEventsPerRun
+long runEventLimit(const TrainingRun& run, const LheIndex* index) {
+    if (!run.sliced()) return nEventsPerRun;
+    return std::max(0L, std::min(run.eventEnd, index->size()) - run.eventBegin);
+}
+
+// Settings shared by every run; the LHE input itself is set by initRun()
+void configurePythia(Pythia& pythia) {
     pythia.readString("Random:setSeed = on");
     pythia.readString("Random:seed = 0");
-    pythia.readString("Beams:frameType = 4");
-    pythia.readString("Beams:LHEF = " + std::string(argv[1]));
     pythia.readString("Beams:eCM = 100.e3");
     pythia.readString("25:onMode = on");
+}
 
-    pythia.init();
+// Point an already configured Pythia at the run's input and initialize it: the whole file
+// through the LHEF reader, an indexed event slice through LHAupSlice, or either through the
+// mmap reader. reuseLHEF swaps the file of a previous LHEF initialization in place
+// (Beams:newLHEFsameInit).
+bool initRun(Pythia& pythia, const TrainingRun& run, const LheIndex* index, bool reuseLHEF, bool mmapReader) {
+    if (run.sliced() || mmapReader) {
+        Pythia8::LHAupPtr reader;
+        if (!mmapReader) {
+            reader = std::make_shared<LHAupSlice>(run.lheFile, *index, run.eventBegin, run.eventEnd);
+        } else if (run.sliced()) {
+            reader = std::make_shared<LHAupMmap>(run.lheFile, *index, run.eventBegin, run.eventEnd);
+        } else {
+            reader = std::make_shared<LHAupMmap>(run.lheFile);
+        }
+        pythia.readString("Beams:newLHEFsameInit = off");
+        pythia.readString("Beams:frameType = 5");
+        pythia.setLHAupPtr(reader);
+    } else {
+        pythia.readString(reuseLHEF ? "Beams:newLHEFsameInit = on" : "Beams:newLHEFsameInit = off");
+        pythia.readString("Beams:frameType = 4");
+        pythia.readString("Beams:LHEF = " + run.lheFile);
+    }
+    return pythia.init();
+}
 
-    std::cout << "Checkpoint: Pythia initialized." << std::endl;
+// Event sources for processRun(): fill snap and return 1, 0 for an event to skip, -1 at the end
+
+// Showers the next event of an initialized Pythia, optionally storing it in an event cache.
+// Events are indexed by their position in the LHE file, failed showers included, so the index
+// stays with the event through a replay of the cache
+struct ShowerSource {
+    Pythia& pythia;
+    evcache::Writer& cache;
+    long lheEvent; // LHE file index of the next event read
+
+    int operator()(EventSnapshot& snap) {
+        const long index = lheEvent++;
+        {
+            memstats::StageScope generation(memstats::Stage::Generation);
+            if (!pythia.next()) return pythia.info.atEndOfFile() ? -1 : 0;
+        }
+        alloccount::Scope countAllocs;
+        snap.fill(pythia.event, pythia.info.code(), pythia.process.size());
+        snap.eventIndex = index;
+        if (cache.isOpen()) {
+            memstats::StageScope output(memstats::Stage::Output);
+            if (!cache.write(snap)) return -1; // Ends the run; cache.close() then reports the failure
+        }
+        return 1;
+    }
+};
+
+// Reads the next event back from an event cache
+struct ReplaySource {
+    evcache::Reader& cache;
+
+    int operator()(EventSnapshot& snap) { return cache.next(snap) ? 1 : -1; }
+};
+
+// Analyse up to nEvents events from nextEvent and write the CSV (and optional .npy / ring) outputs
+template <class EventSource>
+bool processRun(EventSource nextEvent, long nEvents, const TrainingRun& run, const RunCoefficients& coefficients,
+                const detector::Config& detectorConfig, FeatureRingWriter& ring, RunStats& stats, bool reportAllocs) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::ofstream outFile(run.outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Error: Could not open outfile for writing: " << run.outputFile << std::endl;
+        return false;
+    }
+
+    NpyMatrixWriter matrix;
+    if (!run.npyFile.empty() && !matrix.open(run.npyFile, nFeatures)) return false;
 
     // Anti-kt jet clustering with R = 0.4
     double R = 0.4;
     JetDefinition jet_def(antikt_algorithm, R);
 
-    int nEvents = 10000;
     int totalHCount = 0;
+    int nWarmup = 100; // Events before the allocation counter starts
+    long i = 0;
+    bool ok = true; // Cleared when the feature ring's consumer stalls
 
     // Outfile headers
-    outFile << "HiggsBoson, DecayProducts, InvMasses, pT, Rapidity, JetMultiplicity\n";
+    writeRunMetadataLine(outFile, run.lheFile, coefficients.source, coefficients.values);
+    TrainingSchema::writeHeader(outFile, run, ", ");
 
-    for (int i = 0; i < nEvents; i++) {
-        if (!pythia.next()) continue;
+    // Per-event SoA snapshot, output row and scratch buffers, reused across events and candidates
+    EventSnapshot snap;
+    TrainingRow row;
+    HardCandidates<ScalarIds> scalars;
+    float features[nFeatures];
+    std::vector<int> daughterIndices;
+    std::vector<PseudoJet> particles, jets;
+    // Smearing is keyed on the LHE event index carried by the snapshot, so it differs between runs
+    // (manifest points share event indices) but not between a run and its replay
+    detector::Config runDetector = detectorConfig;
+    if (!runDetector.fixedSeed) runDetector.seed = seeds::nameSeed(run.lheFile);
+    detector::Response detector(runDetector);
+    kin::MomentumBatch momenta, jetMomenta;
+    std::vector<double> jetPt;
 
+    for (; ok && i < nEvents; i++) {
+        if (reportAllocs && i == nWarmup) alloccount::reset();
+        int status = nextEvent(snap);
+        if (status < 0) break;
+        if (status == 0) continue;
+        alloccount::Scope countAllocs;
 
-        for (int j = 0; j < pythia.event.size(); j++) {
-            if ((pythia.event[j].id() == 25 || pythia.event[j].id() == 35 || pythia.event[j].id() == 36 || pythia.event[j].id() == 37 || pythia.event[j].id() == -37) && pythia.event[j].status() == -62) {
-                totalHCount++;
+        bool haveParticles = false; // Detector-level final state, built once per event
+        for (int j : scalars.find(snap)) {
+            totalHCount++;
 
-                std::vector<int> decayProducts;
-                std::vector<Vec4> momenta;
+            row.decayIds.clear();
+            momenta.clear();
 
-                for (int k = 0; k < pythia.event.size(); k++) {
-                    if (pythia.event[k].mother1() == j || pythia.event[k].mother2() == j) {
-                        decayProducts.push_back(pythia.event[k].id());
-                        momenta.push_back(pythia.event[k].p());
-                    }
-                }
+            findDaughters(snap, j, daughterIndices);
+            for (int k : daughterIndices) {
+                row.decayIds.push_back(snap.id[k]);
+                momenta.push(snap.px[k], snap.py[k], snap.pz[k], snap.e[k]);
+            }
 
-                if (decayProducts.size() >= 2) {
-                    double invMass = invariantMass(momenta);
-                    double pT = pythia.event[j].pT();
-                    double rapidity = pythia.event[j].y();
-
-                    std::vector<PseudoJet> particles;
-                    for (int k = 0; k < pythia.event.size(); k++) {
-                        if (pythia.event[k].isFinal()) {
-                            PseudoJet particle(pythia.event[k].px(), pythia.event[k].py(), pythia.event[k].pz(), pythia.event[k].e());
-                            particle.set_user_index(k);
-                            particles.push_back(particle);
-                        }
-                    }
+            if (row.decayIds.size() >= 2) {
+                row.higgsId = snap.id[j];
+                row.invMass = invariantMass(momenta);
+                Vec4 pH = snap.p(j);
+                row.pT = pH.pT();
+                row.rapidity = pH.rap();
 
-                    // FastJet clustering
-                    ClusterSequence clustSeq(particles, jet_def);
-                    std::vector<PseudoJet> jets = clustSeq.inclusive_jets();
-                    int jetMultiplicity = 0;
-                    for (const auto& jet : jets) {
-                        if (jet.pt() > 30.0) {
-                            jetMultiplicity++;
-                        }
-                    }
+                memstats::StageScope clustering(memstats::Stage::Clustering);
+                if (!haveParticles) detector.fill(snap, snap.eventIndex, particles);
+                haveParticles = true;
 
-                    // Output all data
-                    outFile << pythia.event[j].id() << ",";
-                    for (size_t d = 0; d < decayProducts.size(); d++) {
-                        outFile << decayProducts[d];
-                        if (d < decayProducts.size() - 1) outFile << ";";
+                // FastJet clustering
+                alloccount::Pause fastjetInternals;
+                ClusterSequence clustSeq(particles, jet_def);
+                jets = clustSeq.inclusive_jets();
+                fastjetInternals.resume();
+                jetMomenta.clear();
+                for (const auto& jet : jets) jetMomenta.push(jet.px(), jet.py(), jet.pz(), jet.e());
+                jetPt.resize(jets.size());
+                kin::ptBatch(jetMomenta.px.data(), jetMomenta.py.data(), jetPt.data(), jetPt.size());
+                row.jetMultiplicity = 0;
+                for (double pt : jetPt) {
+                    if (pt > 30.0) {
+                        row.jetMultiplicity++;
                     }
-                    outFile << "," << invMass << "," << pT << "," << rapidity << "," << jetMultiplicity << "\n";
+                }
+
+                // Output all data
+                memstats::StageScope output(memstats::Stage::Output);
+                TrainingSchema::writeCsv(outFile, row);
+                if (ring.isOpen() || matrix.isOpen()) {
+                    TrainingSchema::writeBinary(row, features);
+                    if (ring.isOpen()) ok = ring.push(features) && ok;
+                    if (matrix.isOpen()) matrix.push(features);
                 }
             }
         }
+        memstats::sample(i);
     }
 
-    // Finished
+    if (reportAllocs) alloccount::report(std::cout, i - nWarmup);
+    if (reportAllocs && detector.enabled()) {
+        std::cout << "Detector response: " << detector.particlesIn() << " final-state particles -> "
+                  << detector.particlesOut() << " clustering inputs" << std::endl;
+    }
+
+    if (matrix.isOpen()) {
+        matrix.close();
+        writeMatrixMetadata(run.npyFile, featureNames, matrix.rows(), run.lheFile, coefficients.source,
+                            coefficients.values);
+    }
     outFile.close();
+
+    stats.events += i;
+    stats.candidates += totalHCount;
+    stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return ok;
+}
+
+// Batch mode: workers each own a Pythia instance and pull runs largest LHE file first, so the
+// longest runs start early and the short ones fill in the tail. Between whole-file runs a worker
+// switches files with Beams:newLHEFsameInit, which swaps the LHE reader without a full re-init;
+// event slices (several lines may split one file) each get their own LHAupSlice.
+int runManifest(const TrainingOptions& options) {
+    std::vector<TrainingRun> runs;
+    if (!readManifest(options.manifestFile, runs)) return 1;
+    if (runs.empty()) {
+        std::cerr << "Error: No runs in manifest " << options.manifestFile << std::endl;
+        return 1;
+    }
+
+    // Index every sliced file once up front, so workers never race to write the same sidecar.
+    // Sliced runs are weighted by their share of the file's events.
+    std::map<std::string, LheIndex> indices;
+    std::vector<double> sizes(runs.size());
+    for (size_t r = 0; r < runs.size(); r++) {
+        const TrainingRun& run = runs[r];
+        sizes[r] = static_cast<double>(fileSize(run.lheFile));
+        if (!run.sliced()) continue;
+        auto found = indices.find(run.lheFile);
+        if (found == indices.end()) {
+            found = indices.emplace(run.lheFile, LheIndex()).first;
+            if (!loadLheIndex(run.lheFile, found->second)) return 1;
+        }
+        const LheIndex& index = found->second;
+        long nSlice = std::min(run.eventEnd, index.size()) - std::min(run.eventBegin, index.size());
+        sizes[r] *= (index.size() > 0) ? double(nSlice) / index.size() : 0.0;
+    }
+    std::vector<size_t> order(runs.size());
+    for (size_t r = 0; r < order.size(); r++) order[r] = r;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    int nWorkers = options.nWorkers > 0 ? options.nWorkers : static_cast<int>(std::thread::hardware_concurrency());
+    nWorkers = std::max(1, std::min(nWorkers, static_cast<int>(runs.size())));
+
+    std::atomic<size_t> next(0);
+    std::atomic<int> nFailed(0);
+    std::mutex logMutex;
+    std::vector<RunStats> workerStats(nWorkers);
+    std::vector<int> workerRuns(nWorkers, 0);
+
+    auto worker = [&](int w) {
+        Pythia pythia;
+        pythia.readString("Print:quiet = on");
+        configurePythia(pythia);
+        FeatureRingWriter noRing;
+        bool lhefReady = false; // Last successful init read a whole file through the LHEF reader
+        for (size_t n = next++; n < order.size(); n = next++) {
+            const TrainingRun& run = runs[order[n]];
+            const LheIndex* index = run.sliced() ? &indices.at(run.lheFile) : nullptr;
+            bool ok = initRun(pythia, run, index, lhefReady, options.mmapReader);
+            lhefReady = ok && !run.sliced() && !options.mmapReader;
+            evcache::Writer cache;
+            RunCoefficients coefficients;
+            ok = ok && (run.cacheFile.empty() || cache.open(run.cacheFile, run.lheFile));
+            ok = ok && resolveCoefficients(run, coefficients);
+            ok = ok && processRun(ShowerSource{pythia, cache, run.eventBegin}, runEventLimit(run, index), run,
+                                  coefficients, options.detector, noRing, workerStats[w], false);
+            ok = cache.close() && ok;
+            if (ok) {
+                workerRuns[w]++;
+            } else {
+                nFailed++;
+            }
+            std::lock_guard<std::mutex> lock(logMutex);
+            std::cout << "Worker " << w << ": " << run.lheFile << (ok ? " -> " + run.outputFile : " failed") << std::endl;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int w = 1; w < nWorkers; w++) threads.emplace_back(worker, w);
+    worker(0);
+    for (auto& thread : threads) thread.join();
+
+    // Throughput summary per worker
+    RunStats total;
+    std::cout << "Worker  Runs  Events  Candidates  Seconds  Events/s" << std::endl;
+    for (int w = 0; w < nWorkers; w++) {
+        const RunStats& stats = workerStats[w];
+        std::cout << w << "  " << workerRuns[w] << "  " << stats.events << "  " << stats.candidates << "  "
+                  << stats.seconds << "  " << (stats.seconds > 0 ? stats.events / stats.seconds : 0.0) << std::endl;
+        total.events += stats.events;
+        total.candidates += stats.candidates;
+        total.seconds = std::max(total.seconds, stats.seconds);
+    }
+    std::cout << "Total  " << runs.size() - nFailed << "  " << total.events << "  " << total.candidates << "  "
+              << total.seconds << "  " << (total.seconds > 0 ? total.events / total.seconds : 0.0) << std::endl;
+    return nFailed > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    TrainingOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    memstats::reportAtExit();
+    if (!options.manifestFile.empty()) return runManifest(options);
+
+    TrainingRun run = options.run;
+    FeatureRingWriter ring;
+    RunStats stats;
+    RunCoefficients coefficients;
+    if (!options.replayFile.empty()) {
+        // Analysis-only rerun from an event cache, without Pythia
+        evcache::Reader cache;
+        if (!cache.open(options.replayFile)) return 1;
+        run.lheFile = cache.source(); // Metadata and BLOCK SMEFT from the LHE file the cache was showered from
+        if (!resolveCoefficients(run, coefficients)) return 1;
+        if (!options.shmName.empty() && !ring.open(options.shmName, nFeatures, coefficients.values)) return 1;
+        bool ok = processRun(ReplaySource{cache}, std::numeric_limits<long>::max(), run, coefficients, options.detector,
+                             ring, stats, false);
+        ring.close();
+        std::cout << "Replayed " << stats.events << " events (" << stats.candidates << " Higgs candidates) from "
+                  << options.replayFile << std::endl;
+        return ok ? 0 : 1;
+    }
+
+    std::ifstream inFile(run.lheFile);
+    if (!inFile.is_open()) {
+        std::cerr << "Error: Could not open LHE file: " << run.lheFile << std::endl;
+        return 1;
+    }
+
+    // The ring header carries the coefficients, so they are known before it becomes visible
+    if (!resolveCoefficients(run, coefficients)) return 1;
+    if (!options.shmName.empty() && !ring.open(options.shmName, nFeatures, coefficients.values)) return 1;
+
+    evcache::Writer cache;
+    if (!run.cacheFile.empty() && !cache.open(run.cacheFile, run.lheFile)) return 1;
+
+    LheIndex index;
+    if (run.sliced() && !loadLheIndex(run.lheFile, index)) return 1;
+
+    // Initialize Pythia with MadGraph LHE file
+    Pythia pythia;
+    std::cout << run.lheFile << std::endl;
+    configurePythia(pythia);
+
+    if (!initRun(pythia, run, &index, false, options.mmapReader)) {
+        std::cerr << "Error: Pythia initialization failed for " << run.lheFile << std::endl;
+        return 1;
+    }
+
+    std::cout << "Checkpoint: Pythia initialized." << std::endl;
+
+    bool ok = processRun(ShowerSource{pythia, cache, run.eventBegin}, runEventLimit(run, &index), run, coefficients,
+                         options.detector, ring, stats, true);
+
+    // Finished
+    ring.close();
+    if (!cache.close() || !ok) return 1;
+    std::cout << "Showered " << stats.events << " events in " << stats.seconds << " s, "
+              << (stats.seconds > 0 ? stats.events / stats.seconds : 0.0) << " events/s" << std::endl;
     std::cout << "Checkpoint: Output file closed, program completed." << std::endl;
-    return 0;
+    return alloccount::exitStatus(0);
 }
@@ -0,0 +1,78 @@
+import mmap
+import os
+import struct
+import time
+import numpy as np
+
+# Reader for the shared-memory feature ring written by training_smeft100.cc --shm <name>.
+# The layout and the producer/consumer protocol are documented in scripts/data/featureRing.h.
+
+MAGIC = b"HSASRING"
+HEAD_OFFSET = 64
+TAIL_OFFSET = 128
+DONE_OFFSET = 192
+LABELS_OFFSET = 256
+
+class FeatureRingReader:
+    """Consume float32 feature batches from a POSIX shared-memory ring without copying."""
+
+    def __init__(self, name, timeout=600.0, poll_interval=0.01):
+        self.path = "/dev/shm/" + name.lstrip("/")
+        self.poll_interval = poll_interval
+
+        # Wait for the generator to create and initialize the segment
+        deadline = time.time() + timeout
+        while True:
+            if os.path.exists(self.path) and os.path.getsize(self.path) >= LABELS_OFFSET:
+                fd = os.open(self.path, os.O_RDWR)
+                self.mm = mmap.mmap(fd, 0)
+                os.close(fd)
+                if self.mm[:8] == MAGIC:
+                    break
+                self.mm.close()
+            if time.time() > deadline:
+                raise TimeoutError(f"No feature ring at {self.path}")
+            time.sleep(poll_interval)
+
+        (self.version, self.n_features, self.rows_per_slot, self.n_slots,
+         self.slot_bytes, self.data_offset, n_labels) = struct.unpack_from("<IIIIQQI", self.mm, 8)
+        self.labels = np.frombuffer(self.mm, dtype=np.float64, count=n_labels, offset=LABELS_OFFSET)
+
+        # Aligned 8-byte loads/stores through these views are single instructions
+        self._head = np.frombuffer(self.mm, dtype=np.uint64, count=1, offset=HEAD_OFFSET)
+        self._tail = np.frombuffer(self.mm, dtype=np.uint64, count=1, offset=TAIL_OFFSET)
+        self._done = np.frombuffer(self.mm, dtype=np.uint32, count=1, offset=DONE_OFFSET)
+
+    def batches(self):
+        """Yield (n_rows, n_features) float32 views into the ring.
+
+        A view is only valid until the next batch is requested, since the slot is then handed
+        back to the producer; copy it if it has to outlive the iteration step.
+        """
+        tail = int(self._tail[0])
+        while True:
+            head = int(self._head[0])
+            if tail == head:
+                if self._done[0] and int(self._head[0]) == tail:
+                    return
+                time.sleep(self.poll_interval)
+                continue
+
+            offset = self.data_offset + (tail % self.n_slots) * self.slot_bytes
+            n_rows = struct.unpack_from("<I", self.mm, offset)[0]
+            view = np.frombuffer(self.mm, dtype=np.float32, count=n_rows * self.n_features, offset=offset + 8)
+            yield view.reshape(n_rows, self.n_features)
+
+            tail += 1
+            self._tail[0] = tail
+
+    def close(self, unlink=True):
+        # Drop our numpy views before unmapping; views still held by the caller keep the
+        # mapping alive until they are released
+        self.labels = self._head = self._tail = self._done = None
+        try:
+            self.mm.close()
+        except BufferError:
+            pass
+        if unlink and os.path.exists(self.path):
+            os.unlink(self.path)
@@ -8,21 +8,29 @@ import glob
 import os
 import sys
 import re
+import json
+from featureRing import FeatureRingReader
 
-def load_dataset(file_path):
-    """Load a single CSV file as a DataFrame."""
-    return pd.read_csv(file_path, header=None)
+# Training input of the form shm:<name> streams from training_smeft100.cc --shm <name>
+STREAM_PREFIX = "shm:"
+STREAM_EPOCHS_PER_BATCH = 1
+# Feature matrices written by training_smeft100.cc --npy, with run metadata in <file>.meta.json
+MATRIX_SUFFIX = ".npy"
 
-def load_wilson_coefficients(data):
-    """Extract Wilson coefficients from the first row of the DataFrame."""
-    # Get the entire first row (assuming the first row contains the coefficients)
-    comment_row = data.iloc[0, :]  # Get the entire first row
-    
-    # Concatenate all columns in the first row to form a single string
-    comment_string = " ".join(comment_row.astype(str).values)
+# First line of the CSVs written by training_smeft100.cc
+RUN_METADATA_PREFIX = "# Run metadata: "
+
+def load_wilson_coefficients(file_path):
+    """Extract Wilson coefficients from the first line of a training CSV."""
+    with open(file_path) as f:
+        comment_string = f.readline()
+    if comment_string.startswith(RUN_METADATA_PREFIX):
+        metadata = json.loads(comment_string[len(RUN_METADATA_PREFIX):])
+        print(f"Wilson coefficients from {metadata['coefficient_source']}")
+        return metadata["wilson_coefficients"]
     print("Comment string:", comment_string)
-    
-    # Use regex to extract all Wilson coefficients
+
+    # Older files: "# Wilson Coefficients: 1: <value>, 2: <value>, ..." prepended by the server
     match = re.findall(r'(\d):\s*(-?\d+\.\d+)', comment_string)
     
     # Create a list of coefficients in order
@@ -45,9 +53,21 @@ def preprocess_features(data):
     
     return X
 
-def train_on_files(training_dataset, model_path="smeft_model.h5"):
-    data = load_dataset(training_dataset)
-    
+def load_coefficients_json(json_path):
+    """Wilson coefficients as written by coefficientUpdate.py, ordered by index."""
+    with open(json_path) as f:
+        coefficients = json.load(f)
+    return [float(coefficients[key]) for key in sorted(coefficients, key=int)]
+
+def load_feature_matrix(matrix_path):
+    """Memory-map a float32 feature matrix and read its run-level Wilson coefficients."""
+    X = np.load(matrix_path, mmap_mode='r')
+    with open(matrix_path + ".meta.json") as f:
+        metadata = json.load(f)
+    coefficients = np.array(metadata["wilson_coefficients"], dtype=np.float32)
+    return X, coefficients
+
+def load_or_create_model(model_path):
     # Check if model exists; if not, create a new one
     if os.path.exists(model_path):
         print("Loading existing model...")
@@ -62,29 +82,83 @@ def train_on_files(training_dataset, model_path="smeft_model.h5"):
             Dense(9)  # 9 outputs for the Wilson coefficients
         ])
         model.compile(optimizer='adam', loss='mse', metrics=['mae'])
+    return model
 
+def train_on_files(training_dataset, model_path="smeft_model.h5"):
+    model = load_or_create_model(model_path)
     
     print(f"Training on {training_dataset}")
 
-    wilson_coefficients = load_wilson_coefficients(data)
+    wilson_coefficients = load_wilson_coefficients(training_dataset)
+    if not wilson_coefficients:
+        raise ValueError(f"{training_dataset} carries no Wilson coefficients")
     wilson_coefficients = np.array(wilson_coefficients)
     data = pd.read_csv(training_dataset, skiprows=1)
     print(data.head())
     
     X = preprocess_features(data)
-    y = np.tile(wilson_coefficients, (X.shape[0], 1)).astype(np.float32)
+    y = np.broadcast_to(wilson_coefficients.astype(np.float32), (X.shape[0], wilson_coefficients.size))
 
     model.fit(X, y, epochs=50, batch_size=32, validation_split=0.2, verbose=1)
     model.save(model_path)
     print(f"Model saved after training on {training_dataset}")
 
-def main(training_dataset, model_path):
-    train_on_files(training_dataset, model_path)
+def train_on_matrix(matrix_path, model_path="smeft_model.h5"):
+    """Train on a .npy feature matrix; the label row is stored once per run and broadcast."""
+    X, wilson_coefficients = load_feature_matrix(matrix_path)
+    if wilson_coefficients.size == 0:
+        raise ValueError(f"{matrix_path}.meta.json carries no Wilson coefficients")
+    print("NUM WILSONS: ", len(wilson_coefficients))
+    model = load_or_create_model(model_path)
+
+    print(f"Training on {matrix_path} ({X.shape[0]} rows)")
+    y = np.broadcast_to(wilson_coefficients, (X.shape[0], wilson_coefficients.size))
+
+    model.fit(X, y, epochs=50, batch_size=32, validation_split=0.2, verbose=1)
+    model.save(model_path)
+    print(f"Model saved after training on {matrix_path}")
+
+def train_on_stream(ring_name, model_path, coefficients_path=None):
+    """Train batch by batch while the generator is still showering."""
+    model = load_or_create_model(model_path)
+    ring = FeatureRingReader(ring_name)
+
+    # Run-level labels from the ring header, or from the coefficient JSON of this run
+    if len(ring.labels) > 0:
+        wilson_coefficients = np.array(ring.labels, dtype=np.float32)
+    elif coefficients_path is not None:
+        wilson_coefficients = np.array(load_coefficients_json(coefficients_path), dtype=np.float32)
+    else:
+        ring.close(unlink=False)
+        raise ValueError("Feature ring carries no Wilson coefficients; pass the coefficient JSON")
+    print("NUM WILSONS: ", len(wilson_coefficients))
+
+    print(f"Training on stream {ring_name}")
+    n_rows = 0
+    for X in ring.batches():
+        # One label row broadcast over the batch; no per-row copies
+        y = np.broadcast_to(wilson_coefficients, (X.shape[0], wilson_coefficients.size))
+        model.fit(X, y, epochs=STREAM_EPOCHS_PER_BATCH, batch_size=32, verbose=0)
+        n_rows += X.shape[0]
+        print(f"Trained on {n_rows} rows")
+    ring.close()
+
+    model.save(model_path)
+    print(f"Model saved after training on stream {ring_name}")
+
+def main(training_dataset, model_path, coefficients_path=None):
+    if training_dataset.startswith(STREAM_PREFIX):
+        train_on_stream(training_dataset[len(STREAM_PREFIX):], model_path, coefficients_path)
+    elif training_dataset.endswith(MATRIX_SUFFIX):
+        train_on_matrix(training_dataset, model_path)
+    else:
+        train_on_files(training_dataset, model_path)
 
 if __name__ == "__main__":
-    if len(sys.argv) != 3:
-        print("Usage: python3 modelTraining.py <input_file> <model_path>")
+    if len(sys.argv) not in (3, 4):
+        print("Usage: python3 modelTraining.py <input_file.csv | input_file.npy | shm:<name>> <model_path> [coefficients_json]")
         sys.exit(1)
     training_dataset = sys.argv[1]
     model_path = sys.argv[2]
-    main(training_dataset, model_path)
+    coefficients_path = sys.argv[3] if len(sys.argv) == 4 else None
+    main(training_dataset, model_path, coefficients_path)
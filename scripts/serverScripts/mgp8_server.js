@@ -1,21 +1,10 @@
 const express = require('express');
 const { spawn } = require('child_process');
-const path = require('path');
-const fs = require('fs');
 const app = express();
 const port = 8080;
 
-function loadWilsonCoefficients(callback) {
-    fs.readFile('wilson_coefficients.json', 'utf8', (err, data) => {
-        if (err) {
-            console.error('Error loading Wilson coefficients:', err);
-            callback(err, null);
-            return;
-        }
-        const coefficients = JSON.parse(data);
-        callback(null, coefficients);
-    });
-}
+// Written by coefficientUpdate.py; pgen7.02 stores it in the first line of its CSV output
+const wilsonCoefficientsFile = '/home/ubuntu/pythia8312/scripts/wilson_coefficients.json';
 
 app.get('/generate', (req, res) => {
     const loopIterations = 10;  // Loop 10 times
@@ -96,7 +85,7 @@ app.get('/generate', (req, res) => {
                                     if (unzipCode === 0) {
                                         // Step 5: Run Pythia script for showering
                                         const pythiaOutput = '/home/ubuntu/pythia8312/scripts/particleData7_02.csv';
-                                        const pythiaChild = spawn('/home/ubuntu/pythia8312/scripts/pgen7.02', [outputLHE, pythiaOutput]);
+                                        const pythiaChild = spawn('/home/ubuntu/pythia8312/scripts/pgen7.02', [outputLHE, pythiaOutput, '--coefficients', wilsonCoefficientsFile]);
 
                                         pythiaChild.stdout.on('data', (data) => {
                                             console.log(`Pythia stdout: ${data}`);
@@ -114,38 +103,13 @@ app.get('/generate', (req, res) => {
                                         pythiaChild.on('close', (pythiaCode) => {
                                             console.log(`Pythia process exited with code ${pythiaCode}`);
                                             if (pythiaCode === 0) {
-                                                // Step 6: Load Wilson coefficients and append to the Pythia output
-                                                loadWilsonCoefficients((err, wilsonCoefficients) => {
-                                                    if (err) {
-                                                        return res.status(500).send(`Error loading Wilson coefficients: ${err.message}`);
-                                                    }
-                                        
-                                                    fs.readFile(pythiaOutput, 'utf8', (err, data) => {
-                                                        if (err) {
-                                                            console.error('Error reading Pythia output CSV:', err);
-                                                            return res.status(500).send(`Error: ${err.message}`);
-                                                        }
-                                        
-                                                        const wilsonString = `# Wilson Coefficients: ${Object.entries(wilsonCoefficients).map(([key, value]) => `${key}: ${value}`).join(', ')}\n`;
-                                                        const newCsvData = wilsonString + data;
-                                                        const finalOutput = path.join('/home/ubuntu/pythia8312/scripts/', `particleData7_02_with_coeffs.csv`);
-                                        
-                                                        fs.writeFile(finalOutput, newCsvData, (err) => {
-                                                            if (err) {
-                                                                console.error('Error writing updated CSV file:', err);
-                                                                return res.status(500).send(`Error: ${err.message}`);
-                                                            }
-                                        
-                                                            // Send file
-                                                            res.sendFile(finalOutput, () => {
-                                                                console.log(`Sent dataset for iteration ${iteration}`);
-                                                                console.log(`Proceeding to iteration ${iteration + 1}`); // Debugging log
-                                                                setTimeout(() => {
-                                                                    runGenerationLoop(iteration + 1); // Proceed to the next iteration
-                                                                }, 5000); // Delay for 5 seconds to ensure previous iteration has completed                                                                
-                                                            });
-                                                        });
-                                                    });
+                                                // Step 6: Send the output, which already carries the Wilson coefficients
+                                                res.sendFile(pythiaOutput, () => {
+                                                    console.log(`Sent dataset for iteration ${iteration}`);
+                                                    console.log(`Proceeding to iteration ${iteration + 1}`); // Debugging log
+                                                    setTimeout(() => {
+                                                        runGenerationLoop(iteration + 1); // Proceed to the next iteration
+                                                    }, 5000); // Delay for 5 seconds to ensure previous iteration has completed
                                                 });
                                             } else {
                                                 res.status(500).send(`Pythia process failed with exit code ${pythiaCode}`);